@@ -0,0 +1,602 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "slideshow.h"
+
+// Benchmark: generates synthetic decks and drives the slide layout and draw
+// code over them for a fixed number of frames. Frames are drawn by the
+// export's CPU renderer, so there is no window, GPU or vsync and runs are
+// repeatable on any machine. Two scenarios draw nothing: "parse" times the
+// deck parser over 10,000 slides, and "build" pushes 100,000 slides straight
+// into the slide store to time it and measure its memory. "idle" runs the
+// player's redraw test (FrameRedraw) over frames where nothing changes and
+// fails unless they are all skipped. Every scenario
+// prints one JSON object per line to stdout (or --out), to be diffed
+// between versions; logs go to stderr.
+//
+// Allocations are counted by wrapping malloc and friends with glibc, which
+// also catches raylib's, and with an allocation hook in the MSVC debug
+// runtime. Fields that cannot be measured on a platform are null.
+
+#define BENCH_IMAGES 8
+
+typedef struct {
+    const char *dir;    // generated decks and images
+    int width;
+    int height;
+    int frames;
+} Bench;
+
+static Bench bench = { "bench-data", 1280, 720, 300 };
+
+typedef struct BenchScenario BenchScenario;
+
+struct BenchScenario {
+    const char *name;
+    int slides;
+    void (*write)(FILE *file, int slide);   // one slide's deck lines
+    bool (*run)(const BenchScenario *scenario, FILE *out);
+};
+
+// The bench runs on one thread, so the counters are plain
+typedef struct {
+    bool counted;           // allocations and bytes are known
+    bool tracked;           // live and peak are known
+    long long allocations;  // malloc, calloc and realloc calls
+    long long bytes;        // requested by them
+    long long live;         // usable bytes currently allocated
+    long long peak;         // most live bytes since reset
+} BenchHeap;
+
+static BenchHeap heap;
+
+#if defined(__GLIBC__)
+
+#include <malloc.h>
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *data, size_t size);
+void __libc_free(void *data);
+
+static void BenchCountAlloc(void *data, size_t size)
+{
+    if (!data) {
+        return;
+    }
+    heap.allocations++;
+    heap.bytes += size;
+    heap.live += malloc_usable_size(data);
+    if (heap.live > heap.peak) {
+        heap.peak = heap.live;
+    }
+}
+
+void *malloc(size_t size)
+{
+    void *data = __libc_malloc(size);
+    BenchCountAlloc(data, size);
+    return data;
+}
+
+void *calloc(size_t count, size_t size)
+{
+    void *data = __libc_calloc(count, size);
+    BenchCountAlloc(data, count * size);
+    return data;
+}
+
+void *realloc(void *data, size_t size)
+{
+    const size_t old = data ? malloc_usable_size(data) : 0;
+    void *resized = __libc_realloc(data, size);
+    if (resized || !size) {
+        heap.live -= old;   // moved, or freed by realloc(data, 0)
+    }
+    BenchCountAlloc(resized, size);
+    return resized;
+}
+
+void free(void *data)
+{
+    if (data) {
+        heap.live -= malloc_usable_size(data);
+    }
+    __libc_free(data);
+}
+
+static void BenchHeapInit(void)
+{
+    heap.counted = true;
+    heap.tracked = true;
+}
+
+#elif defined(_MSC_VER) && defined(_DEBUG)
+
+#include <crtdbg.h>
+
+static int BenchAllocHook(int type, void *data, size_t size, int blockType, long request, const unsigned char *file, int line)
+{
+    (void)data; (void)request; (void)file; (void)line;
+    if (blockType != _CRT_BLOCK && (type == _HOOK_ALLOC || type == _HOOK_REALLOC)) {
+        heap.allocations++;
+        heap.bytes += size;
+    }
+    return 1;
+}
+
+static void BenchHeapInit(void)
+{
+    _CrtSetAllocHook(BenchAllocHook);
+    heap.counted = true;
+}
+
+#else
+
+static void BenchHeapInit(void)
+{
+}
+
+#endif
+
+static const char *benchSentence = "The quick brown fox jumps over the lazy dog";
+
+// Long multi-line paragraphs in every font size
+static void BenchWriteText(FILE *file, int slide)
+{
+    fprintf(file, "slide\ntext 36 10%% Text slide %d\n", slide + 1);
+    for (int r = 0; r < 4; r++) {
+        fprintf(file, "text %d fill", r % 2 ? 16 : 24);
+        for (int l = 0; l < 6; l++) {
+            fprintf(file, "%s%s, line %d", l ? "\\n" : " ", benchSentence, l + 1);
+        }
+        fputc('\n', file);
+    }
+}
+
+// Two large images per slide, from the shared generated set
+static void BenchWriteImages(FILE *file, int slide)
+{
+    fprintf(file, "slide\ntext 36 10%% Image slide %d\n", slide + 1);
+    fprintf(file, "image 40%% %s/image-%d.png\n", bench.dir, slide % BENCH_IMAGES);
+    fprintf(file, "image fill %s/image-%d.png\n", bench.dir, (slide + 3) % BENCH_IMAGES);
+    fprintf(file, "text 24 10%% Caption for image slide %d\n", slide + 1);
+}
+
+// Many short rows of natural height
+static void BenchWriteRows(FILE *file, int slide)
+{
+    fprintf(file, "slide\n");
+    for (int r = 0; r < 200; r++) {
+        fprintf(file, "text 16 auto Row %d of slide %d\n", r + 1, slide + 1);
+    }
+}
+
+// A long deck of the usual kinds of slide
+static void BenchWriteSlides(FILE *file, int slide)
+{
+    switch (slide % 3) {
+        case 0: {
+            fprintf(file, "slide\nempty 35%%\ntext 36 10%% Slide %d\ntext 24 10%% A subtitle for slide %d\nempty 45%%\n",
+                slide + 1, slide + 1);
+            break;
+        }
+        case 1: {
+            fprintf(file, "slide\ntext 36 10%% Photo %d\nimage 70%% %s/image-%d.png\ntext 24 20%% Caption for photo %d\n",
+                slide + 1, bench.dir, slide % BENCH_IMAGES, slide + 1);
+            break;
+        }
+        case 2: {
+            fprintf(file, "slide\ntext 36 10%% Notes %d\ntext 24 fill %s,\\nsecond line\\n\\nand a third after a gap.\n",
+                slide + 1, benchSentence);
+            break;
+        }
+    }
+}
+
+// Gradients of assorted sizes and aspect ratios, written once and reused
+// by later runs
+static bool BenchWriteImageFiles(void)
+{
+    static const int sizes[BENCH_IMAGES][2] = {
+        { 640, 480 }, { 800, 600 }, { 1024, 768 }, { 1280, 720 },
+        { 1600, 900 }, { 1920, 1080 }, { 2048, 1536 }, { 1080, 1920 }
+    };
+    for (int i = 0; i < BENCH_IMAGES; i++) {
+        const char *path = TextFormat("%s/image-%d.png", bench.dir, i);
+        if (FileExists(path)) {
+            continue;
+        }
+        Image image = GenImageGradientLinear(sizes[i][0], sizes[i][1], i * 45, ColorFromHSV(i * 45.0f, 0.6f, 0.9f), DARKBLUE);
+        const bool written = ExportImage(image, path);
+        UnloadImage(image);
+        if (!written) {
+            TraceLog(LOG_WARNING, "BENCH: Failed to write %s", path);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool BenchWriteDeck(const BenchScenario *scenario, const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        TraceLog(LOG_WARNING, "BENCH: Failed to open %s", path);
+        return false;
+    }
+    fprintf(file, "# Generated by bench, scenario '%s'\n", scenario->name);
+    for (int i = 0; i < scenario->slides; i++) {
+        scenario->write(file, i);
+    }
+    const bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+static bool BenchSlideNeedsDecode(const Slide *slide)
+{
+    for (int i = 0; i < slide->rowCount; i++) {
+        const Row *row = &slide->rows[i];
+        if (row->type == Row_Image && images[row->image.image].state == Image_Unloaded) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int BenchCompare(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// A count, or null when it cannot be measured here
+static void BenchPrintCount(FILE *out, const char *key, bool known, double value)
+{
+    if (known) {
+        fprintf(out, ",\"%s\":%.10g", key, value);
+    } else {
+        fprintf(out, ",\"%s\":null", key);
+    }
+}
+
+static long long BenchRowCount(void)
+{
+    long long rowCount = 0;
+    for (int i = 0; i < slideCount; i++) {
+        rowCount += slides[i].rowCount;
+    }
+    return rowCount;
+}
+
+// Load the scenario's deck, then lay out and draw a slide per frame
+static bool BenchRunFrames(const BenchScenario *scenario, FILE *out)
+{
+    char deckPath[4096];
+    snprintf(deckPath, sizeof(deckPath), "%s/%s.txt", bench.dir, scenario->name);
+    if (!BenchWriteDeck(scenario, deckPath)) {
+        return false;
+    }
+
+    heap.peak = heap.live;
+    if (!ExportBegin(deckPath, bench.width, bench.height)) {
+        return false;
+    }
+
+    // Parse again on its own, without the font loading in ExportBegin
+    const double loadStart = PlatformTime();
+    const bool loaded = DeckLoad(deckPath);
+    const double loadSeconds = PlatformTime() - loadStart;
+    double *frameSeconds = malloc(bench.frames * sizeof(double));
+    Image target = GenImageColor(bench.width, bench.height, BLACK);
+    if (!loaded || !slideCount || !frameSeconds || !target.data) {
+        TraceLog(LOG_WARNING, "BENCH: Failed to set up scenario '%s'", scenario->name);
+        free(frameSeconds);
+        UnloadImage(target);
+        ExportEnd();
+        return false;
+    }
+
+    // Decode every image up front, so frames only lay out and draw
+    for (int i = 0; i < slideCount; i++) {
+        if (BenchSlideNeedsDecode(&slides[i])) {
+            ExportRasterize(i, &target);
+        }
+    }
+
+    // Each frame shows the next slide. Every pass over the deck is one pixel
+    // narrower or wider than the previous one, like a window being resized,
+    // so each frame lays its slide out again instead of hitting the cache.
+    const long long allocations = heap.allocations;
+    const long long bytes = heap.bytes;
+    double layoutSeconds = 0;
+    double drawSeconds = 0;
+    for (int f = 0; f < bench.frames; f++) {
+        Slide *current = &slides[f % slideCount];
+        const float width = (float)(bench.width - (f / slideCount) % 2);
+        const double start = PlatformTime();
+        SlideLayout(current, (Rectangle){ 0, 0, width, (float)bench.height });
+        const double laidOut = PlatformTime();
+        ImageClearBackground(&target, BLACK);
+        SlideDrawImage(&target, current);
+        const double end = PlatformTime();
+        layoutSeconds += laidOut - start;
+        drawSeconds += end - laidOut;
+        frameSeconds[f] = end - start;
+    }
+    const long long frameAllocations = heap.allocations - allocations;
+    const long long frameBytes = heap.bytes - bytes;
+
+    double totalSeconds = 0;
+    for (int f = 0; f < bench.frames; f++) {
+        totalSeconds += frameSeconds[f];
+    }
+    qsort(frameSeconds, bench.frames, sizeof(*frameSeconds), BenchCompare);
+
+    const long long rowCount = BenchRowCount();
+    const size_t storeBytes = slideStore.slides.used + slideStore.rows.used + slideStore.data.used;
+    const size_t peakResident = PlatformPeakMemory();
+
+    fprintf(out, "{\"scenario\":\"%s\",\"slides\":%d,\"rows\":%lld,\"width\":%d,\"height\":%d,\"frames\":%d",
+        scenario->name, slideCount, rowCount, bench.width, bench.height, bench.frames);
+    fprintf(out, ",\"loadNs\":%.0f,\"nsPerFrame\":%.0f,\"p50Ns\":%.0f,\"p99Ns\":%.0f,\"layoutNsPerFrame\":%.0f,\"drawNsPerFrame\":%.0f",
+        loadSeconds * 1e9, totalSeconds * 1e9 / bench.frames,
+        frameSeconds[bench.frames / 2] * 1e9, frameSeconds[bench.frames * 99 / 100] * 1e9,
+        layoutSeconds * 1e9 / bench.frames, drawSeconds * 1e9 / bench.frames);
+    BenchPrintCount(out, "allocsPerFrame", heap.counted, frameAllocations / (double)bench.frames);
+    BenchPrintCount(out, "allocBytesPerFrame", heap.counted, frameBytes / (double)bench.frames);
+    BenchPrintCount(out, "peakHeapBytes", heap.tracked, (double)heap.peak);
+    BenchPrintCount(out, "peakResidentBytes", peakResident > 0, (double)peakResident);
+    fprintf(out, ",\"storeBytes\":%zu}\n", storeBytes);
+    fflush(out);
+
+    free(frameSeconds);
+    UnloadImage(target);
+    ExportEnd();
+    return true;
+}
+
+// Parse throughput: the scenario's deck parsed from memory, without reading
+// the file, once the glyphs it needs are cached
+static bool BenchRunParse(const BenchScenario *scenario, FILE *out)
+{
+    char deckPath[4096];
+    snprintf(deckPath, sizeof(deckPath), "%s/%s.txt", bench.dir, scenario->name);
+    if (!BenchWriteDeck(scenario, deckPath) || !ExportBegin(deckPath, bench.width, bench.height)) {
+        return false;
+    }
+
+    // Parsing writes into the text, so every pass parses a fresh copy
+    bool ok = false;
+    char *source = LoadFileText(deckPath);
+    const size_t length = source ? strlen(source) : 0;
+    char *text = malloc(length + 1);
+    double parseSeconds = 0;
+    if (source && text) {
+        SlidesClear();
+        memcpy(text, source, length + 1);
+        const double start = PlatformTime();
+        ok = DeckParse(text, deckPath);
+        parseSeconds = PlatformTime() - start;
+    }
+    if (!ok || !slideCount) {
+        TraceLog(LOG_WARNING, "BENCH: Failed to parse scenario '%s'", scenario->name);
+        ok = false;
+    } else {
+        const size_t storeBytes = slideStore.slides.used + slideStore.rows.used + slideStore.data.used;
+        fprintf(out, "{\"scenario\":\"%s\",\"slides\":%d,\"rows\":%lld,\"bytes\":%zu", scenario->name, slideCount, BenchRowCount(), length);
+        fprintf(out, ",\"parseNs\":%.0f,\"bytesPerSecond\":%.0f,\"slidesPerSecond\":%.0f,\"storeBytes\":%zu}\n",
+            parseSeconds * 1e9, length / parseSeconds, slideCount / parseSeconds, storeBytes);
+        fflush(out);
+    }
+
+    free(text);
+    UnloadFileText(source);
+    ExportEnd();
+    return ok;
+}
+
+// Frames of an idle player: the state only changes on the first frame, when
+// the window is resized halfway through and when the next slide is shown
+// three quarters through. Everything else must be skipped without a redraw.
+static bool BenchRunIdle(const BenchScenario *scenario, FILE *out)
+{
+    char deckPath[4096];
+    snprintf(deckPath, sizeof(deckPath), "%s/%s.txt", bench.dir, scenario->name);
+    if (!BenchWriteDeck(scenario, deckPath) || !ExportBegin(deckPath, bench.width, bench.height)) {
+        return false;
+    }
+    Image target = GenImageColor(bench.width, bench.height, BLACK);
+
+    FrameStatsReset();
+    const int changes = 3;
+    double drawSeconds = 0;
+    for (int f = 0; f < bench.frames; f++) {
+        const FrameState frame = {
+            .slide = f < bench.frames * 3 / 4 ? 0 : 1,
+            .renderWidth = f < bench.frames / 2 ? bench.width : bench.width - 1,
+            .renderHeight = bench.height,
+            .hoveredBox = -1,
+            .imageGeneration = imageGeneration,
+            .deckGeneration = deck.generation,
+            .thumbnailGeneration = thumbnails.generation,
+        };
+        if (FrameRedraw(&frame, true)) {
+            const double start = PlatformTime();
+            Slide *current = &slides[frame.slide];
+            SlideLayout(current, (Rectangle){ 0, 0, (float)frame.renderWidth, (float)frame.renderHeight });
+            ImageClearBackground(&target, BLACK);
+            SlideDrawImage(&target, current);
+            drawSeconds += PlatformTime() - start;
+        }
+    }
+
+    const long long idleRedraws = (long long)frameStats.redraws - changes;
+    const bool ok = bench.frames >= 4 && !idleRedraws;
+    if (!ok) {
+        TraceLog(LOG_WARNING, "BENCH: %lld idle frames of %d were redrawn (needs at least 4 frames)", idleRedraws, bench.frames);
+    }
+    fprintf(out, "{\"scenario\":\"%s\",\"slides\":%d,\"frames\":%llu,\"redraws\":%llu,\"idleRedraws\":%lld,\"drawNsPerRedraw\":%.0f}\n",
+        scenario->name, slideCount, frameStats.frames, frameStats.redraws, idleRedraws,
+        frameStats.redraws ? drawSeconds * 1e9 / frameStats.redraws : 0.0);
+    fflush(out);
+
+    UnloadImage(target);
+    ExportEnd();
+    return ok;
+}
+
+// Slide store stress: slides built straight from the row API, no deck file,
+// reporting build time and how much of the store they take
+static bool BenchRunBuild(const BenchScenario *scenario, FILE *out)
+{
+    static const char *titles[] = { "Owl's Story", "Jan 1, 2003", "Animation Editor", "The End." };
+    static const char *caption =
+        "Allows you to split a spritesheet into frames,\n"
+        "edit frame properties, and create and preview animations.\n";
+    if (!FontLoad(FONT_PATH, false)) {
+        TraceLog(LOG_WARNING, "BENCH: Failed to load %s", FONT_PATH);
+        return false;
+    }
+
+    SlidesClear();
+    heap.peak = heap.live;
+    const double start = PlatformTime();
+    for (int i = 0; i < scenario->slides; i++) {
+        Slide *slide = MakeSlide();
+        if (!slide) {
+            break;
+        }
+        PushRowText(slide, 36, titles[i % 4], 0.1f);
+        switch (i % 3) {
+            case 0: {
+                PushRowEmpty(slide, 0.35f);
+                PushRowText(slide, 24, caption, 0.2f);
+                PushRowEmpty(slide, -1.0f);
+                break;
+            }
+            case 1: {
+                PushRowImage(slide, TextFormat("%s/image-%d.png", bench.dir, i % BENCH_IMAGES), 0.7f);
+                PushRowText(slide, 24, caption, 0.2f);
+                break;
+            }
+            case 2: {
+                for (int r = 0; r < 20; r++) {
+                    PushRowText(slide, 16, titles[r % 4], 0);
+                }
+                break;
+            }
+        }
+    }
+    const double buildSeconds = PlatformTime() - start;
+
+    const bool ok = slideCount == scenario->slides;
+    if (!ok) {
+        TraceLog(LOG_WARNING, "BENCH: Built %d of %d slides in scenario '%s'", slideCount, scenario->slides, scenario->name);
+    } else {
+        const size_t used = slideStore.slides.used + slideStore.rows.used + slideStore.data.used;
+        const size_t committed = slideStore.slides.committed + slideStore.rows.committed + slideStore.data.committed;
+        const size_t peakResident = PlatformPeakMemory();
+        fprintf(out, "{\"scenario\":\"%s\",\"slides\":%d,\"rows\":%lld", scenario->name, slideCount, BenchRowCount());
+        fprintf(out, ",\"buildNs\":%.0f,\"slidesPerSecond\":%.0f", buildSeconds * 1e9, slideCount / buildSeconds);
+        fprintf(out, ",\"storeBytes\":%zu,\"storeCommittedBytes\":%zu,\"slideBytes\":%zu,\"rowBytes\":%zu,\"textBytes\":%zu,\"bytesPerSlide\":%.0f",
+            used, committed, slideStore.slides.used, slideStore.rows.used, slideStore.data.used, used / (double)slideCount);
+        BenchPrintCount(out, "peakHeapBytes", heap.tracked, (double)heap.peak);
+        BenchPrintCount(out, "peakResidentBytes", peakResident > 0, (double)peakResident);
+        fputs("}\n", out);
+        fflush(out);
+    }
+
+    SlidesClear();
+    ImagesUnload();
+    FontUnload();
+    return ok;
+}
+
+// The build runs last, as it raises the peak resident memory the others report
+static const BenchScenario benchScenarios[] = {
+    { "text", 200, BenchWriteText, BenchRunFrames },
+    { "images", 100, BenchWriteImages, BenchRunFrames },
+    { "rows", 50, BenchWriteRows, BenchRunFrames },
+    { "slides", 5000, BenchWriteSlides, BenchRunFrames },
+    { "idle", 3, BenchWriteSlides, BenchRunIdle },
+    { "parse", 10000, BenchWriteSlides, BenchRunParse },
+    { "build", 100000, 0, BenchRunBuild },
+};
+
+static void BenchTraceLog(int logLevel, const char *text, va_list args)
+{
+    static const char *levels[] = { "", "TRACE: ", "DEBUG: ", "INFO: ", "WARNING: ", "ERROR: ", "FATAL: ", "" };
+    fputs(levels[logLevel >= 0 && logLevel < 8 ? logLevel : 0], stderr);
+    vfprintf(stderr, text, args);
+    fputc('\n', stderr);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *scenarioName = 0;
+    const char *outputPath = 0;
+    const char *tracePath = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            bench.frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--size") && i + 1 < argc) {
+            sscanf(argv[++i], "%dx%d", &bench.width, &bench.height);
+        } else if (!strcmp(argv[i], "--dir") && i + 1 < argc) {
+            bench.dir = argv[++i];
+        } else if (!strcmp(argv[i], "--scenario") && i + 1 < argc) {
+            scenarioName = argv[++i];
+        } else if (!strcmp(argv[i], "--out") && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (!strcmp(argv[i], "--trace") && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: bench [--frames N] [--size WxH] [--dir DIR] [--scenario NAME] [--out FILE] [--trace FILE]\n");
+            return 2;
+        }
+    }
+    if (bench.frames <= 0 || bench.width <= 0 || bench.height <= 0) {
+        fprintf(stderr, "bench: frames and size must be positive\n");
+        return 2;
+    }
+
+    SetTraceLogCallback(BenchTraceLog);
+    SetTraceLogLevel(LOG_WARNING);
+    BenchHeapInit();
+    if (tracePath) {
+        TraceInit(tracePath);
+    }
+
+    if (!PlatformMakeDirectory(bench.dir) || !BenchWriteImageFiles()) {
+        TraceLog(LOG_ERROR, "BENCH: Failed to generate data in %s", bench.dir);
+        return 1;
+    }
+    FILE *out = outputPath ? fopen(outputPath, "w") : stdout;
+    if (!out) {
+        TraceLog(LOG_ERROR, "BENCH: Failed to open %s", outputPath);
+        return 1;
+    }
+
+    bool ok = true;
+    int ran = 0;
+    for (int i = 0; i < (int)(sizeof(benchScenarios) / sizeof(*benchScenarios)); i++) {
+        if (scenarioName && strcmp(scenarioName, benchScenarios[i].name)) {
+            continue;
+        }
+        ok &= benchScenarios[i].run(&benchScenarios[i], out);
+        ran++;
+    }
+    if (!ran) {
+        TraceLog(LOG_ERROR, "BENCH: Unknown scenario '%s'", scenarioName);
+        ok = false;
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    TraceShutdown();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,527 @@
+#include <stdlib.h>
+#include <string.h>
+#include "slideshow.h"
+
+// Deck files describe slides one directive per line:
+//
+//   # comment
+//   slide [duration <seconds>] [fade <seconds>]
+//   empty <height>
+//   text <font size> <height> <text, \n for line breaks>
+//   image <height> <path>
+//
+// where <height> is "<percent>%", "fill" (share the leftover height) or
+// "auto" (natural size in pixels). A text <font size> of "fit" picks the
+// largest size at which the wrapped text fills its row, which therefore
+// needs a percent or fill height. Slide durations and cross-fades only
+// matter to the video export, which has defaults for both. The file is
+// parsed in place in a single pass, one slide at a time. Each slide
+// remembers a hash of its lines so DeckReload only parses the slides that
+// were edited.
+
+Deck deck;
+
+static char *DeckSkipSpace(char *c)
+{
+    while (*c == ' ' || *c == '\t') c++;
+    return c;
+}
+
+// Null-terminate the word at c and return the start of the next one
+static char *DeckWord(char *c)
+{
+    while (*c && *c != ' ' && *c != '\t') c++;
+    if (*c) *c++ = 0;
+    return DeckSkipSpace(c);
+}
+
+static bool DeckHeight(const char *word, float *pctHeight)
+{
+    if (!strcmp(word, "auto")) {
+        *pctHeight = 0;
+        return true;
+    }
+    if (!strcmp(word, "fill")) {
+        *pctHeight = -1.0f;
+        return true;
+    }
+
+    char *end = 0;
+    float percent = strtof(word, &end);
+    if (end == word || *end != '%' || end[1] || percent <= 0) {
+        return false;
+    }
+    *pctHeight = percent / 100.0f;
+    return true;
+}
+
+// Resolve \n and \\ escapes in place
+static void DeckUnescape(char *text)
+{
+    char *dst = text;
+    for (const char *src = text; *src; src++) {
+        if (src[0] == '\\' && src[1] == 'n') {
+            *dst++ = '\n';
+            src++;
+        } else if (src[0] == '\\' && src[1] == '\\') {
+            *dst++ = '\\';
+            src++;
+        } else {
+            *dst++ = *src;
+        }
+    }
+    *dst = 0;
+}
+
+static bool DeckIsSlide(char *line)
+{
+    line = DeckSkipSpace(line);
+    return !strncmp(line, "slide", 5) && (!line[5] || strchr(" \t\r\n", line[5]));
+}
+
+// The lines up to the next "slide" line: the preamble before the first
+// slide, then one slide at a time
+typedef struct {
+    char *begin;
+    char *end;
+    int lineNumber;
+    bool isSlide;
+    unsigned long long hash;    // FNV-1a of the raw lines
+} DeckChunk;
+
+// Split off the next chunk and hash it before it is parsed in place, so a
+// reload can tell which slides changed without parsing them
+static bool DeckNextChunk(char **cursor, int *lineNumber, DeckChunk *chunk)
+{
+    char *c = *cursor;
+    if (!*c) {
+        return false;
+    }
+    chunk->begin = c;
+    chunk->lineNumber = *lineNumber;
+    chunk->isSlide = DeckIsSlide(c);
+    for (;;) {
+        char *eol = strchr(c, '\n');
+        if (!eol) {
+            c += strlen(c);
+            break;
+        }
+        c = eol + 1;
+        (*lineNumber)++;
+        if (!*c || DeckIsSlide(c)) {
+            break;
+        }
+    }
+    chunk->end = c;
+
+    unsigned long long hash = 14695981039346656037ull;
+    for (const char *h = chunk->begin; h < chunk->end; h++) {
+        hash = (hash ^ (unsigned char)*h) * 1099511628211ull;
+    }
+    chunk->hash = hash;
+    *cursor = c;
+    return true;
+}
+
+// Parse the rows of one chunk into current, which is null for the preamble
+static bool DeckParseRows(Slide *current, const DeckChunk *chunk, const char *name)
+{
+    int lineNumber = chunk->lineNumber - 1;
+    char *next = chunk->begin;
+    while (next < chunk->end) {
+        char *line = next;
+        lineNumber++;
+
+        next = memchr(line, '\n', chunk->end - line);
+        if (next) {
+            if (next > line && next[-1] == '\r') next[-1] = 0;
+            *next++ = 0;
+        } else {
+            next = chunk->end;
+        }
+
+        line = DeckSkipSpace(line);
+        if (!*line || *line == '#') {
+            continue;
+        }
+
+        char *directive = line;
+        char *args = DeckWord(line);
+
+        if (!strcmp(directive, "slide")) {
+            while (*args) {
+                char *key = args;
+                char *value = DeckWord(key);
+                args = DeckWord(value);
+                char *end = 0;
+                float seconds = strtof(value, &end);
+                bool valid = end != value && !*end && seconds >= 0;
+                if (valid && seconds > 0 && !strcmp(key, "duration")) {
+                    current->duration = seconds;
+                } else if (valid && !strcmp(key, "fade")) {
+                    current->fade = seconds;
+                } else {
+                    TraceLog(LOG_WARNING, "DECK: %s:%d: Expected 'slide [duration <seconds>] [fade <seconds>]'", name, lineNumber);
+                    return false;
+                }
+            }
+            continue;
+        }
+
+        if (!current) {
+            TraceLog(LOG_WARNING, "DECK: %s:%d: '%s' before the first slide", name, lineNumber, directive);
+            return false;
+        }
+
+        Row *row = 0;
+        float pctHeight = 0;
+        if (!strcmp(directive, "empty")) {
+            char *height = args;
+            DeckWord(height);
+            if (!DeckHeight(height, &pctHeight)) {
+                TraceLog(LOG_WARNING, "DECK: %s:%d: Invalid height '%s'", name, lineNumber, height);
+                return false;
+            }
+            row = PushRowEmpty(current, pctHeight);
+        } else if (!strcmp(directive, "text")) {
+            char *size = args;
+            char *height = DeckWord(size);
+            char *body = DeckWord(height);
+            const bool fit = !strcmp(size, "fit");
+            int fontSize = fit ? 0 : atoi(size);
+            if ((!fit && fontSize <= 0) || !DeckHeight(height, &pctHeight)) {
+                TraceLog(LOG_WARNING, "DECK: %s:%d: Expected 'text <font size> <height> <text>'", name, lineNumber);
+                return false;
+            }
+            if (fit && !pctHeight) {
+                TraceLog(LOG_WARNING, "DECK: %s:%d: Text that fits its row needs a percent or fill height", name, lineNumber);
+                return false;
+            }
+            DeckUnescape(body);
+            row = PushRowText(current, (float)fontSize, body, pctHeight);
+        } else if (!strcmp(directive, "image")) {
+            char *height = args;
+            char *path = DeckWord(height);
+            if (!*path || !DeckHeight(height, &pctHeight)) {
+                TraceLog(LOG_WARNING, "DECK: %s:%d: Expected 'image <height> <path>'", name, lineNumber);
+                return false;
+            }
+            if (ImageRegister(path) < 0) {
+                TraceLog(LOG_WARNING, "DECK: %s:%d: Out of memory for image %s", name, lineNumber, path);
+                return false;
+            }
+            row = PushRowImage(current, path, pctHeight);
+        } else {
+            TraceLog(LOG_WARNING, "DECK: %s:%d: Unknown directive '%s'", name, lineNumber, directive);
+            return false;
+        }
+
+        if (!row) {
+            TraceLog(LOG_WARNING, "DECK: %s:%d: Out of memory for rows", name, lineNumber);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DeckParse(char *text, const char *name)
+{
+    char *cursor = text;
+    int lineNumber = 1;
+    DeckChunk chunk;
+    while (DeckNextChunk(&cursor, &lineNumber, &chunk)) {
+        Slide *current = 0;
+        if (chunk.isSlide) {
+            current = MakeSlide();
+            if (!current) {
+                TraceLog(LOG_WARNING, "DECK: %s:%d: Out of memory for slides", name, chunk.lineNumber);
+                return false;
+            }
+            current->sourceHash = chunk.hash;
+        }
+        if (!DeckParseRows(current, &chunk, name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DeckLoad(const char *path)
+{
+    DeckUnload();
+
+    size_t length = strlen(path);
+    deck.path = MemAlloc((unsigned int)length + 1);
+    memcpy(deck.path, path, length + 1);
+
+    if (IsFileExtension(path, ".pack")) {
+        return PackLoad(path);
+    }
+
+    TRACE_BEGIN("DeckLoad");
+    deck.text = LoadFileText(path);
+    const bool ok = deck.text && DeckParse(deck.text, path);
+    TRACE_END("DeckLoad");
+    return ok;
+}
+
+#if defined(__linux__)
+// raylib runs on GLFW here, and an empty event ends the wait that event
+// waiting blocks the main loop in. Weak, so other builds of raylib link and
+// keep polling the watcher every frame instead.
+extern void glfwPostEmptyEvent(void) __attribute__((weak));
+
+// Blocks on the watcher and wakes the main loop once changes arrive, then
+// waits for DeckWatchUpdate to take them before blocking again
+static void DeckWatchThread(void *userData)
+{
+    (void)userData;
+    TraceThreadName("watch");
+    PlatformMutexLock(deck.watchMutex);
+    while (!deck.watchQuit) {
+        if (deck.watchWoken) {
+            PlatformCondWait(deck.watchTaken, deck.watchMutex);
+            continue;
+        }
+        PlatformMutexUnlock(deck.watchMutex);
+        const bool changed = PlatformWatcherWait(deck.watcher);
+        PlatformMutexLock(deck.watchMutex);
+        if (changed && !deck.watchQuit) {
+            deck.watchWoken = true;
+            glfwPostEmptyEvent();
+        }
+    }
+    PlatformMutexUnlock(deck.watchMutex);
+}
+#endif
+
+static void DeckWatchStop(void)
+{
+    if (deck.watchThread) {
+        PlatformMutexLock(deck.watchMutex);
+        deck.watchQuit = true;
+        PlatformCondSignal(deck.watchTaken);
+        PlatformMutexUnlock(deck.watchMutex);
+        PlatformWatcherWake(deck.watcher);
+        PlatformThreadJoin(deck.watchThread);
+    }
+    if (deck.watchMutex) PlatformMutexDestroy(deck.watchMutex);
+    if (deck.watchTaken) PlatformCondDestroy(deck.watchTaken);
+    deck.watchThread = 0;
+    deck.watchMutex = 0;
+    deck.watchTaken = 0;
+    deck.watchWoken = false;
+    deck.watchQuit = false;
+}
+
+void DeckUnload(void)
+{
+    SlidesClear();
+    UnloadFileText(deck.text);
+    deck.text = 0;
+    if (deck.map) {
+        ImagesDetachPacked();
+        PlatformUnmapFile(deck.map, deck.mapSize);
+        deck.map = 0;
+        deck.mapSize = 0;
+    }
+    DeckWatchStop();
+    PlatformWatcherDestroy(deck.watcher);
+    deck.watcher = 0;
+    deck.watchedImages = 0;
+    MemFree(deck.path);
+    deck.path = 0;
+}
+
+// Old slide with the given source hash that has not been reused yet. Tries
+// the same index first, then the same offset as the previous match (slides
+// inserted or removed above), then everything.
+static int DeckFindSlide(const Slide *old, const bool *reused, int oldCount, unsigned long long hash, int index, int *shift)
+{
+    const int guesses[] = { index, index + *shift };
+    for (int g = 0; g < 2; g++) {
+        int i = guesses[g];
+        if (i >= 0 && i < oldCount && !reused[i] && old[i].sourceHash == hash) {
+            return i;
+        }
+    }
+    for (int i = 0; i < oldCount; i++) {
+        if (!reused[i] && old[i].sourceHash == hash) {
+            *shift = i - index;
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Re-read a text deck after it changed on disk. Slides whose lines did not
+// change keep their rows, cached layout and textures; only edited slides are
+// parsed again. If the new file fails to parse, the old slides stay up.
+bool DeckReload(void)
+{
+    if (!deck.path || deck.map) {
+        return false;
+    }
+    char *text = LoadFileText(deck.path);
+    if (!text) {
+        return false;
+    }
+
+    // Reused slides are copied back into the slide arena in their new order.
+    // Their rows stay where they are; rows of replaced slides are left behind
+    // until SlidesCompact. Everything a failed parse pushes past the marks
+    // below is dropped again.
+    const int oldCount = slideCount;
+    const size_t oldUsed = slideStore.slides.used;
+    const size_t oldRowsUsed = slideStore.rows.used;
+    const size_t oldDataUsed = slideStore.data.used;
+    Slide *old = malloc(oldCount * sizeof(Slide) + 1);
+    bool *reused = calloc(oldCount + 1, sizeof(bool));
+    if (!old || !reused) {
+        free(old);
+        free(reused);
+        UnloadFileText(text);
+        return false;
+    }
+    memcpy(old, slides, oldCount * sizeof(Slide));
+    slideStore.slides.used = 0;
+    slideCount = 0;
+
+    bool ok = true;
+    int parsed = 0;
+    int shift = 0;
+    char *cursor = text;
+    int lineNumber = 1;
+    DeckChunk chunk;
+    while (ok && DeckNextChunk(&cursor, &lineNumber, &chunk)) {
+        if (!chunk.isSlide) {
+            ok = DeckParseRows(0, &chunk, deck.path);
+            continue;
+        }
+        Slide *current = MakeSlide();
+        if (!current) {
+            TraceLog(LOG_WARNING, "DECK: %s:%d: Out of memory for slides", deck.path, chunk.lineNumber);
+            ok = false;
+            break;
+        }
+        int match = DeckFindSlide(old, reused, oldCount, chunk.hash, slideCount - 1, &shift);
+        if (match >= 0) {
+            *current = old[match];
+            reused[match] = true;
+            continue;
+        }
+        current->sourceHash = chunk.hash;
+        ok = DeckParseRows(current, &chunk, deck.path);
+        parsed++;
+    }
+    if (ok && !slideCount) {
+        TraceLog(LOG_WARNING, "DECK: %s: No slides", deck.path);
+        ok = false;
+    }
+
+    if (!ok) {
+        memcpy(slideStore.slides.base, old, oldCount * sizeof(Slide));
+        slideStore.slides.used = oldUsed;
+        slideStore.rows.used = oldRowsUsed;
+        slideStore.data.used = oldDataUsed;
+        slideCount = oldCount;
+        slides = (Slide *)slideStore.slides.base;
+        TraceLog(LOG_WARNING, "DECK: Keeping the previous version of %s", deck.path);
+    } else {
+        UnloadFileText(deck.text);
+        deck.text = text;
+        text = 0;
+        if (slide >= slideCount) {
+            slide = slideCount - 1;
+        }
+        textureCache.slide = -1;
+        deck.generation++;
+        TraceLog(LOG_INFO, "DECK: Reloaded %s, %d slides, %d parsed", deck.path, slideCount, parsed);
+
+        // Reclaim the rows of replaced slides once they outweigh the live ones
+        size_t liveRows = 0;
+        for (int i = 0; i < slideCount; i++) {
+            liveRows += slides[i].rowCount * sizeof(Row);
+        }
+        if (slideStore.rows.used > 2 * liveRows + ARENA_COMMIT) {
+            SlidesCompact();
+        }
+    }
+
+    UnloadFileText(text);
+    free(old);
+    free(reused);
+    return ok;
+}
+
+// Reload the deck and its images whenever they change on disk. Packs are
+// compiled output and are not watched. Where the watcher can block, a thread
+// waits on it and wakes the main loop, which can then keep event waiting on;
+// otherwise the main loop has to keep polling DeckWatchUpdate.
+void DeckWatch(void)
+{
+    if (!deck.path || deck.map) {
+        TraceLog(LOG_WARNING, "DECK: Only text decks can be watched");
+        return;
+    }
+    deck.watcher = PlatformWatcherCreate();
+    if (!deck.watcher) {
+        TraceLog(LOG_WARNING, "DECK: Failed to watch %s", deck.path);
+        return;
+    }
+    PlatformWatcherAdd(deck.watcher, deck.path);
+    DeckWatchUpdate();
+#if defined(__linux__)
+    if (glfwPostEmptyEvent) {
+        deck.watchMutex = PlatformMutexCreate();
+        deck.watchTaken = PlatformCondCreate();
+        if (deck.watchMutex && deck.watchTaken) {
+            deck.watchThread = PlatformThreadStart(DeckWatchThread, 0);
+        }
+        if (!deck.watchThread) {
+            DeckWatchStop();
+        }
+    }
+#endif
+    TraceLog(LOG_INFO, "DECK: Watching %s and %d images", deck.path, deck.watchedImages);
+}
+
+// Apply changes to watched files. Returns whether anything was reloaded.
+bool DeckWatchUpdate(void)
+{
+    if (!deck.watcher) {
+        return false;
+    }
+
+    bool changed = false;
+    char path[4096];
+    while (PlatformWatcherPoll(deck.watcher, path, sizeof(path))) {
+        if (!strcmp(path, deck.path)) {
+            TRACE_BEGIN("DeckReload");
+            changed |= DeckReload();
+            TRACE_END("DeckReload");
+            continue;
+        }
+        for (int i = 0; i < imageCount; i++) {
+            if (!strcmp(images[i].path, path)) {
+                ImageReload(i);
+                changed = true;
+                break;
+            }
+        }
+    }
+
+    // Images first used by a reloaded deck
+    for (; deck.watchedImages < imageCount; deck.watchedImages++) {
+        PlatformWatcherAdd(deck.watcher, images[deck.watchedImages].path);
+    }
+
+    // Everything that woke the main loop was taken above
+    if (deck.watchThread) {
+        PlatformMutexLock(deck.watchMutex);
+        deck.watchWoken = false;
+        PlatformCondSignal(deck.watchTaken);
+        PlatformMutexUnlock(deck.watchMutex);
+    }
+    return changed;
+}
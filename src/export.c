@@ -0,0 +1,334 @@
+#include <stdio.h>
+#include <string.h>
+#include "slideshow.h"
+
+// Headless export: every slide is laid out exactly as in the player, drawn
+// into a CPU image and written out as a PNG. Nothing here needs a window,
+// a GPU or a display server, so it runs before InitWindow (e.g. in CI).
+// Slides are rasterized and encoded in parallel on a pool of workers.
+
+#define EXPORT_REFERENCE_HEIGHT 600     // window height the deck's font sizes are meant for
+
+#define MAX_EXPORT_THREADS 64
+
+// A worker's render target. While slide >= 0 it is queued for or being
+// PNG encoded, and the worker rasterizes into its other buffer meanwhile.
+typedef struct {
+    Image image;
+    int slide;
+} ExportBuffer;
+
+// Each worker owns a range of slides: it takes its own from the front, and
+// thieves split off the back half when they run out
+typedef struct {
+    PlatformMutex *mutex;   // guards next/end
+    int next;
+    int end;
+    ExportBuffer buffers[2];
+    int steals;
+} ExportWorker;
+
+typedef struct {
+    PlatformMutex *mutex;   // guards everything below and image decode states
+    PlatformCond *wake;     // an encode finished or an image was decoded
+
+    ExportBuffer *encodeQueue[2 * MAX_EXPORT_THREADS];
+    int encodeHead;
+    int encodeCount;
+    int exported;
+    bool failed;
+
+    ExportWorker workers[MAX_EXPORT_THREADS];
+    int workerCount;
+    const char *outputDir;
+    int width;
+    int height;
+} ExportJob;
+
+static ExportJob job;
+
+// Decode the images on a slide that nobody decoded yet, scaled down to the
+// export size. Their native sizes drive the layout as in the player. Images
+// shared between slides are decoded once, by whichever worker gets there
+// first; the others wait for it.
+static void ExportSlideImages(const Slide *slide)
+{
+    for (int i = 0; i < slide->rowCount; i++) {
+        const Row *row = &slide->rows[i];
+        if (row->type != Row_Image) {
+            continue;
+        }
+        ImageAsset *image = &images[row->image.image];
+        PlatformMutexLock(job.mutex);
+        while (image->state == Image_Queued) {
+            PlatformCondWait(job.wake, job.mutex);
+        }
+        const bool decode = image->state == Image_Unloaded && !image->packed.data;
+        if (decode) {
+            image->state = Image_Queued;
+        }
+        PlatformMutexUnlock(job.mutex);
+        if (!decode) {
+            continue;
+        }
+
+        Image pixels = LoadImage(image->path);
+        const int nativeWidth = pixels.width;
+        const int nativeHeight = pixels.height;
+        ImageFit(&pixels, job.width, job.height);
+
+        PlatformMutexLock(job.mutex);
+        image->image = pixels;
+        image->width = nativeWidth;
+        image->height = nativeHeight;
+        image->state = pixels.data ? Image_Ready : Image_Failed;
+        PlatformCondBroadcast(job.wake);
+        PlatformMutexUnlock(job.mutex);
+    }
+}
+
+static int ExportTakeSlide(ExportWorker *worker)
+{
+    PlatformMutexLock(worker->mutex);
+    if (worker->next < worker->end) {
+        int slide = worker->next++;
+        PlatformMutexUnlock(worker->mutex);
+        return slide;
+    }
+    PlatformMutexUnlock(worker->mutex);
+
+    for (;;) {
+        // Steal from whoever has the most left
+        ExportWorker *victim = 0;
+        int most = 0;
+        for (int i = 0; i < job.workerCount; i++) {
+            ExportWorker *other = &job.workers[i];
+            PlatformMutexLock(other->mutex);
+            int left = other->end - other->next;
+            PlatformMutexUnlock(other->mutex);
+            if (other != worker && left > most) {
+                victim = other;
+                most = left;
+            }
+        }
+        if (!victim) {
+            return -1;
+        }
+
+        PlatformMutexLock(victim->mutex);
+        int left = victim->end - victim->next;
+        int begin = victim->end - (left + 1) / 2;
+        int end = victim->end;
+        if (left > 0) {
+            victim->end = begin;
+        }
+        PlatformMutexUnlock(victim->mutex);
+        if (left <= 0) {
+            continue;
+        }
+
+        PlatformMutexLock(worker->mutex);
+        worker->next = begin + 1;
+        worker->end = end;
+        worker->steals++;
+        PlatformMutexUnlock(worker->mutex);
+        return begin;
+    }
+}
+
+void ExportRasterize(int index, Image *target)
+{
+    TRACE_BEGIN_ARG("Rasterize", index);
+    Slide *slide = &slides[index];
+    ExportSlideImages(slide);
+    SlideLayout(slide, (Rectangle){ 0, 0, (float)job.width, (float)job.height });
+    ImageClearBackground(target, BLACK);
+    SlideDrawImage(target, slide);
+    TRACE_END("Rasterize");
+}
+
+// Workers prefer encoding to rasterizing: finishing an encode frees a
+// buffer, and rasterizing only pays off while there is a buffer to fill.
+// Every worker pushes its rasterized slide to the shared encode queue and
+// moves on to its next slide in its other buffer, so encodes run behind
+// rasterization on whichever cores are free.
+static void ExportThread(void *userData)
+{
+    ExportWorker *worker = userData;
+    TraceThreadName("export");
+    for (;;) {
+        PlatformMutexLock(job.mutex);
+        if (job.encodeCount) {
+            ExportBuffer *buffer = job.encodeQueue[job.encodeHead];
+            job.encodeHead = (job.encodeHead + 1) % (2 * MAX_EXPORT_THREADS);
+            job.encodeCount--;
+            PlatformMutexUnlock(job.mutex);
+
+            char path[4096];
+            snprintf(path, sizeof(path), "%s/slide-%04d.png", job.outputDir, buffer->slide + 1);
+            TRACE_BEGIN_ARG("Encode", buffer->slide);
+            const bool written = ExportImage(buffer->image, path);
+            TRACE_END("Encode");
+            if (!written) {
+                TraceLog(LOG_WARNING, "EXPORT: Failed to write %s", path);
+            }
+
+            PlatformMutexLock(job.mutex);
+            buffer->slide = -1;
+            job.exported += written;
+            job.failed |= !written;
+            PlatformCondBroadcast(job.wake);
+            PlatformMutexUnlock(job.mutex);
+            continue;
+        }
+
+        ExportBuffer *buffer = 0;
+        for (int i = 0; i < 2 && !buffer; i++) {
+            if (worker->buffers[i].slide < 0) {
+                buffer = &worker->buffers[i];
+            }
+        }
+        if (!buffer) {
+            // Both buffers are with other workers' encodes
+            PlatformCondWait(job.wake, job.mutex);
+            PlatformMutexUnlock(job.mutex);
+            continue;
+        }
+        const bool failed = job.failed;
+        PlatformMutexUnlock(job.mutex);
+
+        const int slide = failed ? -1 : ExportTakeSlide(worker);
+        if (slide < 0) {
+            // Encodes queued after this point are picked up by the workers
+            // that queue them
+            PlatformMutexLock(job.mutex);
+            const bool encoding = job.encodeCount > 0;
+            PlatformMutexUnlock(job.mutex);
+            if (encoding) {
+                continue;
+            }
+            break;
+        }
+
+        ExportRasterize(slide, &buffer->image);
+
+        PlatformMutexLock(job.mutex);
+        buffer->slide = slide;
+        job.encodeQueue[(job.encodeHead + job.encodeCount) % (2 * MAX_EXPORT_THREADS)] = buffer;
+        job.encodeCount++;
+        PlatformMutexUnlock(job.mutex);
+    }
+}
+
+void ExportEnd(void)
+{
+    PlatformCondDestroy(job.wake);
+    PlatformMutexDestroy(job.mutex);
+    DeckUnload();
+    ImagesUnload();
+    FontUnload();
+    fontScale = 1.0f;
+}
+
+// Load the CPU glyphs, scaled to the export size, and the deck, and set up
+// the shared job state. Returns false (after cleaning up) on failure.
+bool ExportBegin(const char *deckPath, int width, int height)
+{
+    if (width <= 0 || height <= 0) {
+        TraceLog(LOG_WARNING, "EXPORT: Invalid size %dx%d", width, height);
+        return false;
+    }
+
+    // Text keeps its size relative to the slide at any resolution
+    fontScale = height / (float)EXPORT_REFERENCE_HEIGHT;
+    const bool fontLoaded = FontLoad(FONT_PATH, false);
+
+    memset(&job, 0, sizeof(job));
+    job.mutex = PlatformMutexCreate();
+    job.wake = PlatformCondCreate();
+    job.width = width;
+    job.height = height;
+
+    bool ok = fontLoaded;
+    if (!ok) {
+        TraceLog(LOG_WARNING, "EXPORT: Failed to load %s", FONT_PATH);
+    } else {
+        if (!DeckLoad(deckPath)) {
+            TraceLog(LOG_WARNING, "EXPORT: Failed to fully load deck %s", deckPath);
+        }
+        if (!slideCount) {
+            TraceLog(LOG_WARNING, "EXPORT: Deck %s has no slides", deckPath);
+            ok = false;
+        } else if (!SlidesWrapAlloc()) {
+            // The workers lay slides out in parallel and cannot push to the store
+            TraceLog(LOG_WARNING, "EXPORT: Out of memory for text layout");
+            ok = false;
+        }
+    }
+    if (!ok) {
+        ExportEnd();
+        return false;
+    }
+    return true;
+}
+
+// Render every slide to outputDir/slide-NNNN.png on threadCount threads
+// (0 = one per processor)
+bool ExportDeck(const char *deckPath, const char *outputDir, int width, int height, int threadCount)
+{
+    if (!PlatformMakeDirectory(outputDir)) {
+        TraceLog(LOG_WARNING, "EXPORT: Failed to create %s", outputDir);
+        return false;
+    }
+    if (!ExportBegin(deckPath, width, height)) {
+        return false;
+    }
+
+    if (threadCount <= 0) threadCount = PlatformProcessorCount();
+    if (threadCount > MAX_EXPORT_THREADS) threadCount = MAX_EXPORT_THREADS;
+    if (threadCount > slideCount) threadCount = slideCount;
+
+    job.outputDir = outputDir;
+    job.workerCount = threadCount;
+    for (int i = 0; i < threadCount; i++) {
+        ExportWorker *worker = &job.workers[i];
+        worker->mutex = PlatformMutexCreate();
+        worker->next = (int)((long long)slideCount * i / threadCount);
+        worker->end = (int)((long long)slideCount * (i + 1) / threadCount);
+        for (int b = 0; b < 2; b++) {
+            worker->buffers[b].image = GenImageColor(width, height, BLACK);
+            worker->buffers[b].slide = -1;
+        }
+    }
+
+    // The calling thread is worker 0. Slides of workers that fail to
+    // start are stolen by the others.
+    const double start = PlatformTime();
+    PlatformThread *threads[MAX_EXPORT_THREADS] = { 0 };
+    for (int i = 1; i < threadCount; i++) {
+        threads[i] = PlatformThreadStart(ExportThread, &job.workers[i]);
+    }
+    ExportThread(&job.workers[0]);
+    for (int i = 1; i < threadCount; i++) {
+        if (threads[i]) {
+            PlatformThreadJoin(threads[i]);
+        }
+    }
+    const double elapsed = PlatformTime() - start;
+
+    int steals = 0;
+    for (int i = 0; i < threadCount; i++) {
+        ExportWorker *worker = &job.workers[i];
+        steals += worker->steals;
+        UnloadImage(worker->buffers[0].image);
+        UnloadImage(worker->buffers[1].image);
+        PlatformMutexDestroy(worker->mutex);
+    }
+
+    const bool ok = !job.failed && job.exported == slideCount;
+    printf("export: %d/%d slides at %dx%d on %d threads in %.3f s (%.1f slides/s), %d steals\n",
+        job.exported, slideCount, width, height, threadCount, elapsed, job.exported / elapsed, steals);
+
+    ExportEnd();
+    return ok;
+}
@@ -0,0 +1,569 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "slideshow.h"
+
+// The one font every text is drawn with, as FONT_SDF_SIZE signed distance
+// field glyphs that draw sharp at any size. Glyphs are rasterized on demand:
+// FontLoad only does printable ASCII, and FontCacheText adds whatever other
+// codepoints a text row uses the first time it is pushed, so a deck in any
+// script loads in time proportional to the glyphs it actually uses.
+//
+// In the player new glyphs are packed into a growable atlas image with a
+// skyline packer, and FontUpload sends everything added since the last frame
+// to the atlas texture in one update. The headless export draws straight
+// from the glyph images and has no atlas.
+//
+// Glyphs are only added on the main thread, while nothing else draws text.
+
+Font font;
+Shader fontShader;
+float fontScale = 1.0f;
+GlyphCache glyphCache;
+
+// Signed distance field fragment shader from the raylib SDF font example:
+// the edge is where the distance crosses 0.5, antialiased over one screen
+// pixel at whatever scale the glyph is drawn
+static const char *fontShaderCode =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    float distance = texture(texture0, fragTexCoord).a - 0.5;\n"
+    "    float edge = length(vec2(dFdx(distance), dFdy(distance)));\n"
+    "    float alpha = smoothstep(-edge, edge, distance);\n"
+    "    finalColor = vec4(fragColor.rgb, fragColor.a * alpha) * colDiffuse;\n"
+    "}\n";
+
+static unsigned int GlyphHash(int codepoint)
+{
+    return (unsigned int)codepoint * 2654435761u;
+}
+
+// Glyph index of the codepoint, or -1 when it has not been rasterized yet
+static int FontFindGlyph(int codepoint)
+{
+    if (!glyphCache.lookupSize) {
+        return -1;
+    }
+    const unsigned int mask = glyphCache.lookupSize - 1;
+    for (unsigned int h = GlyphHash(codepoint) & mask;; h = (h + 1) & mask) {
+        const int slot = glyphCache.lookup[h];
+        if (!slot) {
+            return -1;
+        }
+        if (font.glyphs[slot - 1].value == codepoint) {
+            return slot - 1;
+        }
+    }
+}
+
+static bool FontLookupInsert(int codepoint, int index)
+{
+    // Kept at most half full so probe sequences stay short
+    if (2 * (font.glyphCount + 1) > glyphCache.lookupSize) {
+        const int size = glyphCache.lookupSize ? 2 * glyphCache.lookupSize : 256;
+        int *lookup = MemAlloc(size * sizeof(int));
+        if (!lookup) {
+            return false;
+        }
+        MemFree(glyphCache.lookup);
+        glyphCache.lookup = lookup;
+        glyphCache.lookupSize = size;
+        for (int i = 0; i < font.glyphCount; i++) {
+            FontLookupInsert(font.glyphs[i].value, i);
+        }
+    }
+    const unsigned int mask = glyphCache.lookupSize - 1;
+    unsigned int h = GlyphHash(codepoint) & mask;
+    while (glyphCache.lookup[h]) {
+        h = (h + 1) & mask;
+    }
+    glyphCache.lookup[h] = index + 1;
+    return true;
+}
+
+// Glyph index of the codepoint, '?' when it is not cached
+int FontGlyphIndex(int codepoint)
+{
+    const int index = FontFindGlyph(codepoint);
+    return index >= 0 ? index : glyphCache.fallback;
+}
+
+// Lowest y the rect fits at with its left edge on skyline node i, or -1
+static int SkylineFit(int i, int width, int height)
+{
+    const GlyphCache *c = &glyphCache;
+    if (c->skyline[i].x + width > c->atlas.width) {
+        return -1;
+    }
+    int y = c->skyline[i].y;
+    for (int left = width; left > 0; i++) {
+        if (i == c->skylineCount) {
+            return -1;
+        }
+        if (c->skyline[i].y > y) {
+            y = c->skyline[i].y;
+        }
+        if (y + height > c->atlas.height) {
+            return -1;
+        }
+        left -= c->skyline[i].width;
+    }
+    return y;
+}
+
+static bool SkylineReserve(void)
+{
+    GlyphCache *c = &glyphCache;
+    if (c->skylineCount < c->skylineCapacity) {
+        return true;
+    }
+    const int capacity = c->skylineCapacity ? 2 * c->skylineCapacity : 64;
+    SkylineNode *skyline = MemRealloc(c->skyline, capacity * sizeof(SkylineNode));
+    if (!skyline) {
+        return false;
+    }
+    c->skyline = skyline;
+    c->skylineCapacity = capacity;
+    return true;
+}
+
+// Bottom-left skyline packing: place the rect as low as possible, then on
+// the narrowest segment, and raise the skyline under it
+static bool SkylinePack(int width, int height, int *x, int *y)
+{
+    GlyphCache *c = &glyphCache;
+    int best = -1;
+    int bestY = 0;
+    for (int i = 0; i < c->skylineCount; i++) {
+        const int fit = SkylineFit(i, width, height);
+        if (fit >= 0 && (best < 0 || fit < bestY || (fit == bestY && c->skyline[i].width < c->skyline[best].width))) {
+            best = i;
+            bestY = fit;
+        }
+    }
+    if (best < 0 || !SkylineReserve()) {
+        return false;
+    }
+
+    *x = c->skyline[best].x;
+    *y = bestY;
+    memmove(&c->skyline[best + 1], &c->skyline[best], (c->skylineCount - best) * sizeof(SkylineNode));
+    c->skyline[best] = (SkylineNode){ *x, bestY + height, width };
+    c->skylineCount++;
+
+    // Trim the nodes now under the new one
+    for (int i = best + 1; i < c->skylineCount;) {
+        const SkylineNode *prev = &c->skyline[i - 1];
+        SkylineNode *node = &c->skyline[i];
+        const int overlap = prev->x + prev->width - node->x;
+        if (overlap <= 0) {
+            break;
+        }
+        node->x += overlap;
+        node->width -= overlap;
+        if (node->width > 0) {
+            break;
+        }
+        memmove(node, node + 1, (c->skylineCount - i - 1) * sizeof(SkylineNode));
+        c->skylineCount--;
+    }
+    // Merge neighbours at the same height
+    for (int i = 0; i + 1 < c->skylineCount;) {
+        if (c->skyline[i].y == c->skyline[i + 1].y) {
+            c->skyline[i].width += c->skyline[i + 1].width;
+            memmove(&c->skyline[i + 1], &c->skyline[i + 2], (c->skylineCount - i - 2) * sizeof(SkylineNode));
+            c->skylineCount--;
+        } else {
+            i++;
+        }
+    }
+    return true;
+}
+
+// Double the atlas, the shorter side first. Packed glyphs keep their place
+// and the texture is created again on the next upload.
+static bool FontAtlasGrow(void)
+{
+    GlyphCache *c = &glyphCache;
+    const int width = c->atlas.height < c->atlas.width ? c->atlas.width : 2 * c->atlas.width;
+    const int height = c->atlas.height < c->atlas.width ? 2 * c->atlas.height : c->atlas.height;
+    if (width > GLYPH_ATLAS_MAX_SIZE || height > GLYPH_ATLAS_MAX_SIZE || !SkylineReserve()) {
+        return false;
+    }
+    unsigned char *pixels = MemAlloc(width * height * 2);
+    if (!pixels) {
+        return false;
+    }
+    for (int i = 0; i < width * height; i++) {
+        pixels[2 * i] = 255;    // white, the distance is in alpha
+    }
+    for (int y = 0; y < c->atlas.height; y++) {
+        memcpy(pixels + y * width * 2, (unsigned char *)c->atlas.data + y * c->atlas.width * 2, c->atlas.width * 2);
+    }
+    if (width > c->atlas.width) {
+        c->skyline[c->skylineCount++] = (SkylineNode){ c->atlas.width, 0, width - c->atlas.width };
+    }
+    MemFree(c->atlas.data);
+    c->atlas = (Image){ pixels, width, height, 1, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA };
+    c->grown = true;
+    TraceLog(LOG_INFO, "FONT: Glyph atlas grown to %dx%d", width, height);
+    return true;
+}
+
+// Copy a glyph into the atlas and record its rect there
+static void FontAtlasAdd(int index)
+{
+    GlyphCache *c = &glyphCache;
+    const Image *glyph = &font.glyphs[index].image;
+    font.recs[index] = (Rectangle){ 0, 0, (float)glyph->width, (float)glyph->height };
+    if (!glyph->data || !glyph->width || !glyph->height) {
+        return;
+    }
+
+    // One pixel apart, so bilinear filtering never picks up a neighbour
+    int x = 0;
+    int y = 0;
+    while (!SkylinePack(glyph->width + 1, glyph->height + 1, &x, &y)) {
+        if (!FontAtlasGrow()) {
+            if (!c->full) {
+                TraceLog(LOG_WARNING, "FONT: Glyph atlas full at %dx%d, new glyphs are not drawn", c->atlas.width, c->atlas.height);
+                c->full = true;
+            }
+            font.recs[index] = (Rectangle){ 0 };
+            return;
+        }
+    }
+
+    const unsigned char *distance = glyph->data;
+    unsigned char *pixels = c->atlas.data;
+    for (int gy = 0; gy < glyph->height; gy++) {
+        for (int gx = 0; gx < glyph->width; gx++) {
+            pixels[((y + gy) * c->atlas.width + x + gx) * 2 + 1] = distance[gy * glyph->width + gx];
+        }
+    }
+    font.recs[index] = (Rectangle){ (float)x, (float)y, (float)glyph->width, (float)glyph->height };
+
+    Rectangle *dirty = &c->dirty;
+    if (!dirty->width) {
+        *dirty = font.recs[index];
+    } else {
+        const float right = fmaxf(dirty->x + dirty->width, x + (float)glyph->width);
+        const float bottom = fmaxf(dirty->y + dirty->height, y + (float)glyph->height);
+        dirty->x = fminf(dirty->x, (float)x);
+        dirty->y = fminf(dirty->y, (float)y);
+        dirty->width = right - dirty->x;
+        dirty->height = bottom - dirty->y;
+    }
+}
+
+// Rasterize the given codepoints, none of which may be cached yet, in one
+// LoadFontData call
+static bool FontAddGlyphs(int *codepoints, int count)
+{
+    TRACE_BEGIN_ARG("RasterizeGlyphs", count);
+    if (font.glyphCount + count > glyphCache.capacity) {
+        int capacity = glyphCache.capacity ? glyphCache.capacity : 128;
+        while (capacity < font.glyphCount + count) {
+            capacity *= 2;
+        }
+        GlyphInfo *glyphs = MemRealloc(font.glyphs, capacity * sizeof(GlyphInfo));
+        Rectangle *recs = glyphs ? MemRealloc(font.recs, capacity * sizeof(Rectangle)) : 0;
+        if (glyphs) font.glyphs = glyphs;
+        if (recs) font.recs = recs;
+        if (!glyphs || !recs) {
+            TRACE_END("RasterizeGlyphs");
+            return false;
+        }
+        glyphCache.capacity = capacity;
+    }
+
+    GlyphInfo *added = LoadFontData(glyphCache.data, glyphCache.dataSize, FONT_SDF_SIZE, codepoints, count, FONT_SDF);
+    if (!added) {
+        TRACE_END("RasterizeGlyphs");
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        const int index = font.glyphCount;
+        font.glyphs[index] = added[i];
+        font.glyphs[index].value = codepoints[i];
+        if (!FontLookupInsert(codepoints[i], index)) {
+            UnloadImage(added[i].image);
+            continue;
+        }
+        font.glyphCount++;
+        if (glyphCache.atlas.data) {
+            FontAtlasAdd(index);
+        } else {
+            const Image *glyph = &font.glyphs[index].image;
+            font.recs[index] = (Rectangle){ 0, 0, (float)glyph->width, (float)glyph->height };
+        }
+    }
+    MemFree(added);     // the glyph images now belong to font.glyphs
+    TRACE_END("RasterizeGlyphs");
+    return true;
+}
+
+static int CompareCodepoints(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+// Make sure every codepoint of the UTF-8 text has a glyph
+void FontCacheText(const char *text)
+{
+    if (!font.glyphs) {
+        return;
+    }
+    int count = 0;
+    int *codepoints = LoadCodepoints(text, &count);
+    if (!codepoints) {
+        return;
+    }
+    int missing = 0;
+    for (int i = 0; i < count; i++) {
+        if (codepoints[i] != '\n' && FontFindGlyph(codepoints[i]) < 0) {
+            codepoints[missing++] = codepoints[i];
+        }
+    }
+    if (missing) {
+        qsort(codepoints, missing, sizeof(int), CompareCodepoints);
+        int unique = 1;
+        for (int i = 1; i < missing; i++) {
+            if (codepoints[i] != codepoints[unique - 1]) {
+                codepoints[unique++] = codepoints[i];
+            }
+        }
+        FontAddGlyphs(codepoints, unique);
+    }
+    UnloadCodepoints(codepoints);
+}
+
+// Load the font and rasterize printable ASCII. With upload the glyphs also
+// go into the atlas and the shader is compiled, which needs a window;
+// without, only the CPU glyph images are kept, for the headless export.
+bool FontLoad(const char *path, bool upload)
+{
+    TRACE_BEGIN("FontLoad");
+    memset(&glyphCache, 0, sizeof(glyphCache));
+    font = (Font){ 0 };
+    glyphCache.data = LoadFileData(path, &glyphCache.dataSize);
+    if (!glyphCache.data) {
+        TRACE_END("FontLoad");
+        return false;
+    }
+    font.baseSize = FONT_SDF_SIZE;
+    if (upload) {
+        const int size = GLYPH_ATLAS_INITIAL_SIZE;
+        unsigned char *pixels = MemAlloc(size * size * 2);
+        if (!pixels || !SkylineReserve()) {
+            MemFree(pixels);
+            FontUnload();
+            TRACE_END("FontLoad");
+            return false;
+        }
+        for (int i = 0; i < size * size; i++) {
+            pixels[2 * i] = 255;
+        }
+        glyphCache.atlas = (Image){ pixels, size, size, 1, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA };
+        glyphCache.skyline[0] = (SkylineNode){ 0, 0, size };
+        glyphCache.skylineCount = 1;
+    }
+
+    int ascii[95];
+    for (int i = 0; i < 95; i++) {
+        ascii[i] = 32 + i;
+    }
+    if (!FontAddGlyphs(ascii, 95)) {
+        FontUnload();
+        TRACE_END("FontLoad");
+        return false;
+    }
+    glyphCache.fallback = FontFindGlyph('?');
+
+    if (upload) {
+        FontUpload();
+        fontShader = LoadShaderFromMemory(0, fontShaderCode);
+    }
+    TRACE_END("FontLoad");
+    return true;
+}
+
+// Send the glyphs added since the last call to the atlas texture: one
+// partial update, or a new texture if the atlas grew. Main thread, once a
+// frame before anything is drawn.
+void FontUpload(void)
+{
+    GlyphCache *c = &glyphCache;
+    if (!c->atlas.data || (!c->grown && !c->dirty.width && font.texture.id)) {
+        return;
+    }
+    TRACE_BEGIN("FontUpload");
+    if (c->grown || !font.texture.id) {
+        if (font.texture.id) {
+            UnloadTexture(font.texture);
+        }
+        font.texture = LoadTextureFromImage(c->atlas);
+        SetTextureFilter(font.texture, TEXTURE_FILTER_BILINEAR);
+    } else {
+        Image dirty = ImageFromImage(c->atlas, c->dirty);
+        UpdateTextureRec(font.texture, c->dirty, dirty.data);
+        UnloadImage(dirty);
+    }
+    c->grown = false;
+    c->dirty = (Rectangle){ 0 };
+    TRACE_END("FontUpload");
+}
+
+void FontUnload(void)
+{
+    if (font.glyphs) {
+        UnloadFontData(font.glyphs, font.glyphCount);
+    }
+    MemFree(font.recs);
+    if (font.texture.id) {
+        UnloadTexture(font.texture);
+        UnloadShader(fontShader);
+    }
+    UnloadFileData(glyphCache.data);
+    MemFree(glyphCache.lookup);
+    MemFree(glyphCache.skyline);
+    MemFree(glyphCache.atlas.data);
+    memset(&glyphCache, 0, sizeof(glyphCache));
+    font = (Font){ 0 };
+    fontShader = (Shader){ 0 };
+}
+
+// How far the pen moves past a glyph at scale (fontSize / font.baseSize),
+// spacing aside. Glyphs without an advance move by their width, as DrawTextEx
+// draws them. Everything that measures or places text uses this, so lines
+// are measured and wrapped with the same advances they are drawn with.
+float FontGlyphAdvance(int index, float scale)
+{
+    const GlyphInfo *glyph = &font.glyphs[index];
+    return (glyph->advanceX ? glyph->advanceX : font.recs[index].width) * scale;
+}
+
+// Width of one line of text at the given size, summed from glyph advances
+// like MeasureTextEx. Unlike MeasureTextEx it does not need the font
+// texture, so it also works for the CPU-only glyphs of the headless export.
+float TextLineWidth(const char *text, float fontSize, float spacing)
+{
+    float width = 0;
+    int count = 0;
+    for (int i = 0; text[i];) {
+        int size = 0;
+        int index = FontGlyphIndex(GetCodepointNext(&text[i], &size));
+        i += size;
+        width += FontGlyphAdvance(index, 1.0f);
+        count++;
+    }
+    return count ? width * fontSize / font.baseSize + (count - 1) * spacing : 0;
+}
+
+// DrawTextEx for the first length bytes of one line, with the cached glyph
+// lookup instead of GetGlyphIndex's linear search. Draw inside
+// BeginShaderMode(fontShader).
+void DrawTextLine(const char *text, int length, Vector2 position, float fontSize, float spacing, Color tint)
+{
+    const float scale = fontSize / font.baseSize;
+    float x = position.x;
+    for (int i = 0; i < length;) {
+        int size = 0;
+        int codepoint = GetCodepointNext(&text[i], &size);
+        int index = FontGlyphIndex(codepoint);
+        i += size;
+        const GlyphInfo *glyph = &font.glyphs[index];
+        const Rectangle src = font.recs[index];
+        if (codepoint != ' ' && codepoint != '\t' && src.width) {
+            Rectangle dest = { x + glyph->offsetX * scale, position.y + glyph->offsetY * scale, src.width * scale, src.height * scale };
+            DrawTexturePro(font.texture, src, dest, (Vector2){ 0, 0 }, 0.0f, tint);
+        }
+        x += FontGlyphAdvance(index, scale) + spacing;
+    }
+}
+
+// Distance field texel, 0 (far outside the glyph) beyond its edges
+static float GlyphDistance(const Image *glyph, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= glyph->width || y >= glyph->height) {
+        return 0;
+    }
+    return ((const unsigned char *)glyph->data)[y * glyph->width + x] / 255.0f;
+}
+
+// Draw a distance field glyph scaled at (x, y) the way the GPU does: sampled
+// bilinearly at each pixel center, then thresholded like the font shader
+// over the distance change to the next pixel
+static void ImageDrawGlyph(Image *dst, const Image *glyph, float x, float y, float scale, Color tint)
+{
+    const int x0 = x > 0 ? (int)x : 0;
+    const int y0 = y > 0 ? (int)y : 0;
+    const int x1 = (int)ceilf(x + glyph->width * scale) < dst->width ? (int)ceilf(x + glyph->width * scale) : dst->width;
+    const int y1 = (int)ceilf(y + glyph->height * scale) < dst->height ? (int)ceilf(y + glyph->height * scale) : dst->height;
+    Color *pixels = dst->data;
+    for (int py = y0; py < y1; py++) {
+        const float gy = (py + 0.5f - y) / scale - 0.5f;
+        const int iy = (int)floorf(gy);
+        const float fy = gy - iy;
+        for (int px = x0; px < x1; px++) {
+            const float gx = (px + 0.5f - x) / scale - 0.5f;
+            const int ix = (int)floorf(gx);
+            const float fx = gx - ix;
+            const float d00 = GlyphDistance(glyph, ix, iy);
+            const float d10 = GlyphDistance(glyph, ix + 1, iy);
+            const float d01 = GlyphDistance(glyph, ix, iy + 1);
+            const float d11 = GlyphDistance(glyph, ix + 1, iy + 1);
+            const float top = d00 + (d10 - d00) * fx;
+            const float bottom = d01 + (d11 - d01) * fx;
+            const float distance = top + (bottom - top) * fy - 0.5f;
+
+            // Bilinear gradient, in distance per screen pixel
+            const float dx = ((d10 - d00) + ((d11 - d01) - (d10 - d00)) * fy) / scale;
+            const float dy = (bottom - top) / scale;
+            const float edge = sqrtf(dx * dx + dy * dy);
+            if (distance <= -edge || (distance <= 0 && edge == 0)) {
+                continue;
+            }
+            float alpha = 1.0f;
+            if (distance < edge) {
+                const float t = (distance + edge) / (2 * edge);
+                alpha = t * t * (3 - 2 * t);
+            }
+            alpha *= tint.a / 255.0f;
+
+            Color *p = &pixels[py * dst->width + px];
+            p->r = (unsigned char)(p->r + (tint.r - p->r) * alpha);
+            p->g = (unsigned char)(p->g + (tint.g - p->g) * alpha);
+            p->b = (unsigned char)(p->b + (tint.b - p->b) * alpha);
+            p->a = (unsigned char)(p->a + (255 - p->a) * alpha);
+        }
+    }
+}
+
+// Draw the first length bytes of one line of text into an RGBA CPU image,
+// glyph by glyph, placed the same way as DrawTextEx places them on screen
+void ImageDrawTextLine(Image *dst, const char *text, int length, Vector2 position, float fontSize, float spacing, Color tint)
+{
+    if (dst->format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        return;
+    }
+    const float scale = fontSize / font.baseSize;
+    float x = position.x;
+    for (int i = 0; i < length;) {
+        int size = 0;
+        int codepoint = GetCodepointNext(&text[i], &size);
+        int index = FontGlyphIndex(codepoint);
+        i += size;
+        const GlyphInfo *glyph = &font.glyphs[index];
+        if (codepoint != ' ' && codepoint != '\t' && glyph->image.data) {
+            ImageDrawGlyph(dst, &glyph->image, x + glyph->offsetX * scale, position.y + glyph->offsetY * scale, scale, tint);
+        }
+        x += FontGlyphAdvance(index, scale) + spacing;
+    }
+}
@@ -0,0 +1,350 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "slideshow.h"
+
+// The player: parses the command line, runs the headless modes or opens
+// the window, and drives the main loop. Everything it draws with lives in
+// the other files, which the benchmark links as well.
+
+int main(int argc, char *argv[])
+{
+    const char *deckPath = "deck.txt";
+    bool idleMode = true;
+    const char *packPath = 0;
+    int packMaxWidth = 1920;
+    int packMaxHeight = 1080;
+    bool watch = false;
+    const char *tracePath = 0;
+    const char *exportDir = 0;
+    int exportWidth = 1920;
+    int exportHeight = 1080;
+    int exportThreads = 0;
+    const char *videoPath = 0;
+    int videoFps = 30;
+    float videoSlideSeconds = 5.0f;
+    float videoFadeSeconds = 0.5f;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--compile") && i + 1 < argc) {
+            packPath = argv[++i];
+        } else if (!strcmp(argv[i], "--pack-size") && i + 1 < argc) {
+            sscanf(argv[++i], "%dx%d", &packMaxWidth, &packMaxHeight);
+        } else if (!strcmp(argv[i], "--export") && i + 1 < argc) {
+            exportDir = argv[++i];
+        } else if (!strcmp(argv[i], "--export-size") && i + 1 < argc) {
+            sscanf(argv[++i], "%dx%d", &exportWidth, &exportHeight);
+        } else if (!strcmp(argv[i], "--video") && i + 1 < argc) {
+            videoPath = argv[++i];
+        } else if (!strcmp(argv[i], "--fps") && i + 1 < argc) {
+            videoFps = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--slide-duration") && i + 1 < argc) {
+            videoSlideSeconds = (float)atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--fade") && i + 1 < argc) {
+            videoFadeSeconds = (float)atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            exportThreads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--watch")) {
+            watch = true;
+        } else if (!strcmp(argv[i], "--trace") && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (!strcmp(argv[i], "--profile")) {
+            profiler.visible = true;
+        } else if (!strcmp(argv[i], "--no-idle")) {
+            idleMode = false;
+        } else if (!strcmp(argv[i], "--texture-budget") && i + 1 < argc) {
+            textureCache.budget = atoll(argv[++i]) * 1024LL * 1024LL;
+        } else if (!strcmp(argv[i], "--prefetch") && i + 1 < argc) {
+            textureCache.prefetchSlides = atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            deckPath = argv[i];
+        }
+    }
+
+    if (tracePath) {
+        TraceInit(tracePath);
+    }
+
+    // Headless, before any window or GPU context exists
+    if (exportDir || videoPath) {
+        const bool ok = exportDir ?
+            ExportDeck(deckPath, exportDir, exportWidth, exportHeight, exportThreads) :
+            ExportVideo(deckPath, videoPath, exportWidth, exportHeight, videoFps, videoSlideSeconds, videoFadeSeconds);
+        TraceShutdown();
+        return ok ? 0 : 1;
+    }
+    if (packPath) {
+        // Text is measured with the CPU glyphs; nothing is drawn
+        bool ok = FontLoad(FONT_PATH, false);
+        if (!ok) {
+            TraceLog(LOG_ERROR, "SLIDESHOW: Failed to load %s", FONT_PATH);
+        }
+        ok = ok && PackCompile(deckPath, packPath, packMaxWidth, packMaxHeight);
+        ImagesUnload();
+        FontUnload();
+        TraceShutdown();
+        return ok ? 0 : 1;
+    }
+
+    InitWindow(800, 600, "Slideshow");
+    SetWindowState(FLAG_WINDOW_RESIZABLE);
+    SetWindowState(FLAG_VSYNC_HINT);
+
+    if (!FontLoad(FONT_PATH, true)) {
+        TraceLog(LOG_ERROR, "SLIDESHOW: Failed to load %s", FONT_PATH);
+        TraceShutdown();
+        CloseWindow();
+        return 1;
+    }
+
+    LoaderInit();
+
+    if (!DeckLoad(deckPath)) {
+        TraceLog(LOG_WARNING, "SLIDESHOW: Failed to fully load deck %s", deckPath);
+    }
+    if (!slideCount) {
+        TraceLog(LOG_ERROR, "SLIDESHOW: Deck %s has no slides", deckPath);
+        LoaderShutdown();
+        TraceShutdown();
+        CloseWindow();
+        return 1;
+    }
+    if (watch) {
+        DeckWatch();
+    }
+    ThumbnailsInit();
+    TextMeshesInit();
+
+    const float barSize = 16;
+    const float iconMargin = 4;
+    const float boxMargin = 2;
+    const float boxWidth = THUMBNAIL_WIDTH + 2 * boxMargin;
+    const float footerHeight = THUMBNAIL_HEIGHT + 2 * boxMargin;
+
+    // In idle mode EndDrawing/PollInputEvents block until the next input or
+    // window event, and frames whose state did not change are not redrawn.
+    // While images are still loading nothing would wake the loop, so event
+    // waiting is only enabled once the loader is idle. Watched files wake it
+    // from the deck's watch thread; without one they are polled instead.
+    bool eventWaiting = false;
+
+    // The footer strip shows one box per slide starting at footerFirst. It
+    // follows the current slide whenever that changes, and the mouse wheel
+    // over the strip scrolls it freely in between.
+    int footerFirst = 0;
+    int footerSlide = -1;   // slide the strip last followed
+
+    while (!WindowShouldClose()) {
+        ProfilerFrameBegin();
+        DeckWatchUpdate();
+        LoaderUpload(UPLOAD_BUDGET_SECONDS);
+        FontUpload();
+
+        ProfilerPhaseBegin(Phase_Input);
+        const Vector2 mouse = GetMousePosition();
+
+        const int boxBarY = GetRenderHeight() - footerHeight;
+        const float wheel = GetMouseWheelMove();
+        const bool overFooter = mouse.y >= boxBarY && mouse.y < GetRenderHeight() && mouse.x >= 0;
+
+        if (IsKeyPressed(KEY_RIGHT) || IsKeyPressedRepeat(KEY_RIGHT) ||
+            (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && mouse.y > barSize && mouse.y < boxBarY) ||
+            (wheel < 0 && !overFooter))
+        {
+            if (slide < slideCount - 1) {
+                slide++;
+            }
+        }
+        if (IsKeyPressed(KEY_LEFT) || IsKeyPressedRepeat(KEY_LEFT) ||
+            (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) && mouse.y > barSize && mouse.y < boxBarY) ||
+            (wheel > 0 && !overFooter))
+        {
+            if (slide) {
+                slide--;
+            }
+        }
+        if (IsKeyPressed(KEY_HOME)) {
+            slide = 0;
+        }
+        if (IsKeyPressed(KEY_END)) {
+            slide = slideCount - 1;
+        }
+        if (IsKeyPressed(KEY_F3)) {
+            profiler.visible = !profiler.visible;
+        }
+        if (IsKeyPressed(KEY_F4) && tracePath) {
+            TraceDump(tracePath);
+        }
+
+        // Only the boxes in view are ever touched, so the strip costs the
+        // same at any deck size
+        int footerBoxes = (int)(GetRenderWidth() / boxWidth);  // fully visible
+        if (footerBoxes < 1) {
+            footerBoxes = 1;
+        }
+        if (slide != footerSlide) {
+            if (slide < footerFirst) {
+                footerFirst = slide;
+            } else if (slide >= footerFirst + footerBoxes) {
+                footerFirst = slide - footerBoxes + 1;
+            }
+            footerSlide = slide;
+        }
+        if (overFooter && wheel) {
+            const int step = footerBoxes / 4 > 1 ? footerBoxes / 4 : 1;
+            footerFirst -= (int)(wheel * step);
+        }
+        if (footerFirst > slideCount - footerBoxes) {
+            footerFirst = slideCount - footerBoxes;
+        }
+        if (footerFirst < 0) {
+            footerFirst = 0;
+        }
+
+        int hoveredBox = -1;
+        if (overFooter) {
+            const int i = footerFirst + (int)(mouse.x / boxWidth);
+            if (i < slideCount) {
+                if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
+                    slide = footerSlide = i;
+                } else {
+                    hoveredBox = i;
+                }
+            }
+        }
+        ProfilerPhaseEnd(Phase_Input);
+
+        const float slideY = UI_FONT_SIZE + 8.0f;
+        const Rectangle slideArea = { 0, slideY, (float)GetRenderWidth(), boxBarY - slideY };
+        ProfilerPhaseBegin(Phase_Layout);
+        SlideLayout(&slides[slide], slideArea);
+        ProfilerPhaseEnd(Phase_Layout);
+
+        TextureCacheUpdate(slide);
+        TextureCacheCheckResolution(&slides[slide]);
+
+        // Plus the partly visible box at the right edge
+        const int footerEnd = footerFirst + footerBoxes + 1 < slideCount ? footerFirst + footerBoxes + 1 : slideCount;
+        ThumbnailsUpdate(footerFirst, footerEnd, slideArea);
+
+        const bool polling = LoaderPending() > 0 || thumbnails.pending > 0 || (deck.watcher && !deck.watchThread) || profiler.visible;
+        if (idleMode && eventWaiting == polling) {
+            eventWaiting = !polling;
+            if (eventWaiting) {
+                EnableEventWaiting();
+            } else {
+                DisableEventWaiting();
+            }
+        }
+
+        const FrameState frame = {
+            .slide = slide,
+            .renderWidth = GetRenderWidth(),
+            .renderHeight = GetRenderHeight(),
+            .hoveredBox = hoveredBox,
+            .footerFirst = footerFirst,
+            .imageGeneration = imageGeneration,
+            .deckGeneration = deck.generation,
+            .thumbnailGeneration = thumbnails.generation,
+            .profiler = profiler.visible
+        };
+        if (!FrameRedraw(&frame, idleMode && !profiler.visible)) {
+            PollInputEvents();
+            if (!eventWaiting) {
+                WaitTime(IDLE_POLL_SECONDS);
+            }
+            TRACE_END("Frame");
+            continue;
+        }
+
+        ClearBackground(BLACK);
+        BeginDrawing();
+
+        // Header
+        DrawRectangle(0, 0, GetRenderWidth(), barSize, ColorBrightness(DARKGRAY, -0.5f));
+        BeginShaderMode(fontShader);
+        const char *position = TextFormat("%d of %d", slide + 1, slideCount);
+        DrawTextLine(position, (int)strlen(position), (Vector2){ 4, 0 }, UI_FONT_SIZE, 1.0f, WHITE);
+        EndShaderMode();
+        if (profiler.visible) {
+            ProfilerDraw((Rectangle){ 0, 0, (float)GetRenderWidth(), barSize });
+        }
+
+        // Slide
+        ProfilerPhaseBegin(Phase_Rows);
+        SlideDraw(&slides[slide]);
+        ProfilerPhaseEnd(Phase_Rows);
+
+        // Footer
+        ProfilerPhaseBegin(Phase_Footer);
+        DrawRectangle(0, boxBarY, GetRenderWidth(), (int)footerHeight, ColorBrightness(DARKGRAY, -0.5f));
+        const unsigned char *summaries = SlideSummaries();
+
+        // Box highlights, and the summary icon for slides whose thumbnail
+        // is not drawn yet
+        for (int i = footerFirst; i < footerEnd; i++) {
+            Rectangle rec = { (i - footerFirst) * boxWidth, (float)boxBarY, boxWidth, footerHeight };
+            Color color = i == slide ? BLUE : BLANK;
+            if (i == hoveredBox) {
+                color = SKYBLUE;
+            }
+            DrawRectangleRec(rec, color);
+
+            Rectangle source;
+            if (ThumbnailSource(i, &source)) {
+                continue;
+            }
+            const unsigned char summary = summaries ? summaries[i] : 0;
+            rec = (Rectangle){ rec.x + (rec.width - barSize) / 2, rec.y + (rec.height - barSize) / 2, barSize, barSize };
+            if (summary & SLIDE_SUMMARY_IMAGE) {
+                Vector2 v1 = { rec.x + iconMargin            , rec.y + rec.height - iconMargin };  // bottom left
+                Vector2 v2 = { rec.x + rec.width - iconMargin, rec.y + rec.height - iconMargin };  // bottom right
+                Vector2 v3 = { rec.x + rec.width / 2         , rec.y + iconMargin              };  // top middle
+                DrawTriangle(v1, v2, v3, PURPLE);
+            } else if (summary & SLIDE_SUMMARY_TEXT) {
+                rec.x += iconMargin;
+                rec.y += iconMargin;
+                rec.width -= iconMargin * 2;
+                rec.height -= iconMargin * 2;
+                DrawRectangleRec(rec, LIGHTGRAY);
+            }
+        }
+
+        // Thumbnails, all from the one atlas texture so they batch together
+        for (int i = footerFirst; i < footerEnd; i++) {
+            Rectangle source;
+            if (ThumbnailSource(i, &source)) {
+                const Rectangle dest = { (i - footerFirst) * boxWidth + boxMargin, boxBarY + boxMargin, THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT };
+                DrawTexturePro(thumbnails.atlas.texture, source, dest, (Vector2){ 0, 0 }, 0.0f, WHITE);
+            }
+        }
+
+        // Where the strip is in the deck, when it does not fit
+        if (slideCount > footerBoxes) {
+            const float scale = GetRenderWidth() / (float)slideCount;
+            DrawRectangleRec((Rectangle){ footerFirst * scale, (float)boxBarY, footerBoxes * scale, 2 }, GRAY);
+        }
+        ProfilerPhaseEnd(Phase_Footer);
+
+        ProfilerPhaseBegin(Phase_Present);
+        EndDrawing();
+        ProfilerPhaseEnd(Phase_Present);
+        ProfilerFrameEnd();
+    }
+
+    TraceLog(LOG_INFO, "SLIDESHOW: %llu frames, %llu redraws, %llu idle",
+        frameStats.frames, frameStats.redraws, frameStats.frames - frameStats.redraws);
+    TraceLog(LOG_INFO, "SLIDESHOW: Texture cache %u hits, %u misses, %u prefetches, %u evictions, %lld/%lld KiB resident",
+        textureCache.hits, textureCache.misses, textureCache.prefetches, textureCache.evictions,
+        textureCache.used / 1024, textureCache.budget / 1024);
+    TraceLog(LOG_INFO, "SLIDESHOW: Thumbnails %u drawn, %u evictions", thumbnails.drawn, thumbnails.evictions);
+    TraceLog(LOG_INFO, "SLIDESHOW: Text meshes %u built, %u evictions", textMeshes.built, textMeshes.evictions);
+
+    TextMeshesUnload();
+    FontUnload();
+    ThumbnailsUnload();
+    LoaderShutdown();
+    TraceShutdown();
+    DeckUnload();
+    CloseWindow();
+    return 0;
+}
\ No newline at end of file
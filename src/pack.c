@@ -0,0 +1,436 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "slideshow.h"
+
+// A deck pack is a deck compiled into a single file that the player maps and
+// uses in place: text rows point at their pre-split, pre-measured lines in
+// the mapping and images are uploaded straight from pre-decoded, pre-scaled
+// pixels. Loading a pack does no parsing, measuring or decoding and never
+// reads the text: it copies the fixed-size slide and row headers, caches
+// the deck's glyphs from one string of all of them, and registers each image
+// once. Rows get their wrap buffers when they are first laid out.
+//
+// Layout: header, slides, rows, lines, strings, images, then pixel data.
+// Everything is in native byte order; packs are not meant to be portable
+// between architectures.
+
+#define PACK_MAGIC "SSPK"
+#define PACK_VERSION 5
+#define PACK_ALIGN 16
+
+typedef struct {
+    char magic[4];
+    unsigned int version;
+    unsigned int slideCount;
+    unsigned int rowCount;
+    unsigned int lineCount;
+    unsigned int imageCount;
+    unsigned int stringsSize;
+    unsigned int glyphs;            // offset in strings of every codepoint the deck uses
+    unsigned long long slides;      // file offset of each section
+    unsigned long long rows;
+    unsigned long long lines;
+    unsigned long long strings;
+    unsigned long long images;
+} PackHeader;
+
+typedef struct {
+    unsigned int firstRow;
+    unsigned int rowCount;
+    float duration;         // video export timing, see Slide
+    float fade;
+} PackSlide;
+
+typedef struct {
+    int type;
+    float percent;
+    Vector2 pixels;         // natural size, pre-measured for text rows
+    int fontSize;
+    unsigned int text;      // offset of the row's line buffer in strings
+    unsigned int firstLine;
+    int lineCount;
+    int wrapCapacity;       // lines plus spaces, what wrapping can break the text into
+    int image;              // index into pack images, -1 if none
+} PackRow;
+
+typedef struct {
+    unsigned int path;      // offset in strings
+    int width;              // native size
+    int height;
+    int pixelWidth;         // stored size, scaled down to the pack's max size
+    int pixelHeight;
+    int format;
+    unsigned long long pixels;  // file offset
+} PackImage;
+
+static int PackLineBufferSize(const RowText *text)
+{
+    if (!text->lineCount) {
+        return 1;
+    }
+    const RowTextLine *last = &text->lines[text->lineCount - 1];
+    return last->offset + last->length + 1;
+}
+
+static void PackPad(FILE *file)
+{
+    static const char zeros[PACK_ALIGN] = { 0 };
+    const long long offset = PlatformFileTell(file);
+    if (offset % PACK_ALIGN) {
+        fwrite(zeros, 1, PACK_ALIGN - offset % PACK_ALIGN, file);
+    }
+}
+
+// Compile a text deck into a pack. Images are decoded and scaled down to fit
+// maxWidth x maxHeight (times the row's percent height) on this machine.
+bool PackCompile(const char *deckPath, const char *packPath, int maxWidth, int maxHeight)
+{
+    if (!DeckLoad(deckPath)) {
+        TraceLog(LOG_WARNING, "PACK: Failed to load deck %s", deckPath);
+        DeckUnload();
+        return false;
+    }
+
+    // Assign pack indices to the images the deck uses, and how tall they may be drawn
+    int *imagePackIndex = malloc((imageCount + 1) * sizeof(*imagePackIndex));
+    float *imagePercent = malloc((imageCount + 1) * sizeof(*imagePercent));
+    int *deckImage = malloc((imageCount + 1) * sizeof(*deckImage));
+    FILE *file = 0;
+    if (!imagePackIndex || !imagePercent || !deckImage) {
+        TraceLog(LOG_WARNING, "PACK: Out of memory for %d images", imageCount);
+    } else {
+        file = fopen(packPath, "wb");
+        if (!file) {
+            TraceLog(LOG_WARNING, "PACK: Failed to open %s for writing", packPath);
+        }
+    }
+    if (!file) {
+        free(imagePackIndex);
+        free(imagePercent);
+        free(deckImage);
+        DeckUnload();
+        return false;
+    }
+
+    int packImageCount = 0;
+    int rowCount = 0;
+    int lineCount = 0;
+    unsigned int stringsSize = 0;
+    for (int i = 0; i < imageCount; i++) {
+        imagePackIndex[i] = -1;
+    }
+    for (int i = 0; i < slideCount; i++) {
+        for (int r = 0; r < slides[i].rowCount; r++) {
+            const Row *row = &slides[i].rows[r];
+            rowCount++;
+            if (row->type == Row_Text) {
+                lineCount += row->text.lineCount;
+                stringsSize += PackLineBufferSize(&row->text);
+            } else if (row->type == Row_Image) {
+                int image = row->image.image;
+                if (imagePackIndex[image] < 0) {
+                    imagePackIndex[image] = packImageCount;
+                    deckImage[packImageCount] = image;
+                    imagePercent[packImageCount] = 0;
+                    packImageCount++;
+                    stringsSize += (unsigned int)strlen(images[image].path) + 1;
+                }
+                float percent = row->size.percent > 0 && row->size.percent < 1 ? row->size.percent : 1.0f;
+                if (percent > imagePercent[imagePackIndex[image]]) {
+                    imagePercent[imagePackIndex[image]] = percent;
+                }
+            }
+        }
+    }
+
+    // Every glyph the deck loaded, so loading the pack caches them at once
+    unsigned int glyphsSize = 1;
+    for (int i = 0; i < font.glyphCount; i++) {
+        int size = 0;
+        CodepointToUTF8(font.glyphs[i].value, &size);
+        glyphsSize += size;
+    }
+    stringsSize += glyphsSize;
+
+    PackHeader header = { 0 };
+    memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
+    header.version = PACK_VERSION;
+    header.slideCount = slideCount;
+    header.rowCount = rowCount;
+    header.lineCount = lineCount;
+    header.imageCount = packImageCount;
+    header.stringsSize = stringsSize;
+    fwrite(&header, sizeof(header), 1, file);
+
+    PackPad(file);
+    header.slides = PlatformFileTell(file);
+    unsigned int firstRow = 0;
+    for (int i = 0; i < slideCount; i++) {
+        PackSlide packSlide = { firstRow, slides[i].rowCount, slides[i].duration, slides[i].fade };
+        fwrite(&packSlide, sizeof(packSlide), 1, file);
+        firstRow += slides[i].rowCount;
+    }
+
+    PackPad(file);
+    header.rows = PlatformFileTell(file);
+    unsigned int firstLine = 0;
+    unsigned int text = 0;
+    for (int i = 0; i < slideCount; i++) {
+        for (int r = 0; r < slides[i].rowCount; r++) {
+            const Row *row = &slides[i].rows[r];
+            PackRow packRow = { row->type, row->size.percent, row->size.pixels, 0, 0, 0, 0, 0, -1 };
+            if (row->type == Row_Text) {
+                packRow.fontSize = (int)row->text.fontSize;
+                packRow.text = text;
+                packRow.firstLine = firstLine;
+                packRow.lineCount = row->text.lineCount;
+                packRow.wrapCapacity = row->text.wrapCapacity;
+                text += PackLineBufferSize(&row->text);
+                firstLine += row->text.lineCount;
+            } else if (row->type == Row_Image) {
+                packRow.image = imagePackIndex[row->image.image];
+            }
+            fwrite(&packRow, sizeof(packRow), 1, file);
+        }
+    }
+
+    PackPad(file);
+    header.lines = PlatformFileTell(file);
+    for (int i = 0; i < slideCount; i++) {
+        for (int r = 0; r < slides[i].rowCount; r++) {
+            const Row *row = &slides[i].rows[r];
+            if (row->type == Row_Text) {
+                for (int l = 0; l < row->text.lineCount; l++) {
+                    RowTextLine line = row->text.lines[l];
+                    line.x = 0;
+                    fwrite(&line, sizeof(line), 1, file);
+                }
+            }
+        }
+    }
+
+    PackPad(file);
+    header.strings = PlatformFileTell(file);
+    for (int i = 0; i < slideCount; i++) {
+        for (int r = 0; r < slides[i].rowCount; r++) {
+            const Row *row = &slides[i].rows[r];
+            if (row->type == Row_Text) {
+                fwrite(row->text.lineBuffer, 1, PackLineBufferSize(&row->text), file);
+            }
+        }
+    }
+    unsigned int path = text;
+    for (int i = 0; i < packImageCount; i++) {
+        const char *imagePath = images[deckImage[i]].path;
+        fwrite(imagePath, 1, strlen(imagePath) + 1, file);
+        text += (unsigned int)strlen(imagePath) + 1;
+    }
+    header.glyphs = text;
+    for (int i = 0; i < font.glyphCount; i++) {
+        int size = 0;
+        const char *utf8 = CodepointToUTF8(font.glyphs[i].value, &size);
+        fwrite(utf8, 1, size, file);
+    }
+    fputc(0, file);
+
+    // The image table is rewritten once the pixel offsets are known
+    PackPad(file);
+    header.images = PlatformFileTell(file);
+    PackImage *packImages = MemAlloc(packImageCount * sizeof(*packImages) + 1);
+    fwrite(packImages, sizeof(*packImages), packImageCount, file);
+
+    bool ok = true;
+    for (int i = 0; i < packImageCount; i++) {
+        const char *imagePath = images[deckImage[i]].path;
+        PackImage *packImage = &packImages[i];
+        packImage->path = path;
+        path += (unsigned int)strlen(imagePath) + 1;
+
+        Image image = LoadImage(imagePath);
+        if (!image.data) {
+            TraceLog(LOG_WARNING, "PACK: Failed to load image %s", imagePath);
+            ok = false;
+            continue;
+        }
+        packImage->width = image.width;
+        packImage->height = image.height;
+
+        int imageMaxHeight = (int)ceilf(maxHeight * imagePercent[i]);
+        if (image.width > maxWidth || image.height > imageMaxHeight) {
+            float scale = fminf(maxWidth / (float)image.width, imageMaxHeight / (float)image.height);
+            int width = (int)ceilf(image.width * scale);
+            int height = (int)ceilf(image.height * scale);
+            ImageResize(&image, width > 0 ? width : 1, height > 0 ? height : 1);
+        }
+        packImage->pixelWidth = image.width;
+        packImage->pixelHeight = image.height;
+        packImage->format = image.format;
+
+        PackPad(file);
+        packImage->pixels = PlatformFileTell(file);
+        fwrite(image.data, 1, GetPixelDataSize(image.width, image.height, image.format), file);
+        UnloadImage(image);
+    }
+
+    PlatformFileSeek(file, (long long)header.images);
+    fwrite(packImages, sizeof(*packImages), packImageCount, file);
+    PlatformFileSeek(file, 0);
+    fwrite(&header, sizeof(header), 1, file);
+    MemFree(packImages);
+
+    if (ferror(file)) {
+        TraceLog(LOG_WARNING, "PACK: Failed to write %s", packPath);
+        ok = false;
+    }
+    fclose(file);
+
+    TraceLog(LOG_INFO, "PACK: Compiled %s into %s (%d slides, %d rows, %d images)",
+        deckPath, packPath, slideCount, rowCount, packImageCount);
+    free(imagePackIndex);
+    free(imagePercent);
+    free(deckImage);
+    DeckUnload();
+    return ok;
+}
+
+static bool PackSectionValid(unsigned long long offset, unsigned long long count, size_t itemSize, size_t fileSize)
+{
+    return offset <= fileSize && count <= (fileSize - offset) / itemSize;
+}
+
+// Every line of a text row lies inside the strings section, so measuring
+// and wrapping never read past the mapping
+static bool PackLinesValid(const PackHeader *header, const PackRow *packRow, const RowTextLine *lines)
+{
+    for (int l = 0; l < packRow->lineCount; l++) {
+        const RowTextLine *line = &lines[packRow->firstLine + l];
+        if (line->offset < 0 || line->length < 0 ||
+            (unsigned long long)packRow->text + line->offset + line->length >= header->stringsSize)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool PackImageValid(const PackHeader *header, const PackImage *packImage, size_t fileSize)
+{
+    unsigned long long pixelsSize = GetPixelDataSize(packImage->pixelWidth, packImage->pixelHeight, packImage->format);
+    return packImage->path < header->stringsSize && PackSectionValid(packImage->pixels, pixelsSize, 1, fileSize);
+}
+
+bool PackLoad(const char *path)
+{
+    size_t size = 0;
+    unsigned char *data = PlatformMapFile(path, &size);
+    if (!data) {
+        TraceLog(LOG_WARNING, "PACK: Failed to map %s", path);
+        return false;
+    }
+
+    const PackHeader *header = (const PackHeader *)data;
+    if (size < sizeof(*header) || memcmp(header->magic, PACK_MAGIC, sizeof(header->magic)) ||
+        header->version != PACK_VERSION ||
+        !PackSectionValid(header->slides, header->slideCount, sizeof(PackSlide), size) ||
+        !PackSectionValid(header->rows, header->rowCount, sizeof(PackRow), size) ||
+        !PackSectionValid(header->lines, header->lineCount, sizeof(RowTextLine), size) ||
+        !PackSectionValid(header->strings, header->stringsSize, 1, size) ||
+        !header->stringsSize || data[header->strings + header->stringsSize - 1] || header->glyphs >= header->stringsSize ||
+        !PackSectionValid(header->images, header->imageCount, sizeof(PackImage), size))
+    {
+        TraceLog(LOG_WARNING, "PACK: %s is not a valid version %d deck pack", path, PACK_VERSION);
+        PlatformUnmapFile(data, size);
+        return false;
+    }
+    deck.map = data;
+    deck.mapSize = size;
+
+    const PackSlide *packSlides = (const PackSlide *)(data + header->slides);
+    const PackRow *packRows = (const PackRow *)(data + header->rows);
+    RowTextLine *lines = (RowTextLine *)(data + header->lines);
+    char *strings = (char *)(data + header->strings);
+    const PackImage *packImages = (const PackImage *)(data + header->images);
+
+    // Once for the whole deck instead of per line, and each image once
+    // instead of per row; the rows then find theirs by path
+    FontCacheText(strings + header->glyphs);
+    for (unsigned int i = 0; i < header->imageCount; i++) {
+        const PackImage *packImage = &packImages[i];
+        if (!PackImageValid(header, packImage, size)) {
+            continue;
+        }
+        const int image = ImageRegister(strings + packImage->path);
+        if (image >= 0) {
+            Image pixels = {
+                .data = data + packImage->pixels,
+                .width = packImage->pixelWidth,
+                .height = packImage->pixelHeight,
+                .mipmaps = 1,
+                .format = packImage->format
+            };
+            ImageAttachPacked(image, pixels, packImage->width, packImage->height);
+        }
+    }
+
+    for (unsigned int i = 0; i < header->slideCount; i++) {
+        const PackSlide *packSlide = &packSlides[i];
+        if (packSlide->firstRow > header->rowCount || packSlide->rowCount > header->rowCount - packSlide->firstRow) {
+            TraceLog(LOG_WARNING, "PACK: %s: Slide %u has invalid rows", path, i);
+            goto fail;
+        }
+
+        Slide *slide = MakeSlide();
+        if (!slide) {
+            TraceLog(LOG_WARNING, "PACK: %s: Out of memory for slides", path);
+            goto fail;
+        }
+        slide->duration = packSlide->duration;
+        slide->fade = packSlide->fade;
+
+        for (unsigned int r = 0; r < packSlide->rowCount; r++) {
+            const PackRow *packRow = &packRows[packSlide->firstRow + r];
+            Row *row = 0;
+            switch (packRow->type) {
+                case Row_Text: {
+                    if (packRow->text >= header->stringsSize || packRow->firstLine > header->lineCount ||
+                        packRow->lineCount < 0 || (unsigned int)packRow->lineCount > header->lineCount - packRow->firstLine ||
+                        packRow->wrapCapacity < packRow->lineCount ||
+                        (unsigned int)(packRow->wrapCapacity - packRow->lineCount) > header->stringsSize - packRow->text ||
+                        !PackLinesValid(header, packRow, lines))
+                    {
+                        break;
+                    }
+                    row = PushRowTextMeasured(slide, (float)packRow->fontSize, strings + packRow->text,
+                        lines + packRow->firstLine, packRow->lineCount, packRow->wrapCapacity, packRow->pixels, packRow->percent);
+                    break;
+                }
+                case Row_Image: {
+                    if (packRow->image < 0 || (unsigned int)packRow->image >= header->imageCount) {
+                        break;
+                    }
+                    const PackImage *packImage = &packImages[packRow->image];
+                    if (PackImageValid(header, packImage, size)) {
+                        row = PushRowImage(slide, strings + packImage->path, packRow->percent);
+                    }
+                    break;
+                }
+                default: {
+                    row = PushRowEmpty(slide, packRow->percent);
+                    break;
+                }
+            }
+            if (!row) {
+                TraceLog(LOG_WARNING, "PACK: %s: Invalid row %u on slide %u", path, r, i);
+                goto fail;
+            }
+        }
+    }
+    return true;
+
+fail:
+    // Nothing of a half-loaded pack is kept, and it is unmapped
+    DeckUnload();
+    return false;
+}
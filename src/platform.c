@@ -0,0 +1,630 @@
+#include <stdlib.h>
+#include <string.h>
+#include "platform.h"
+
+#if defined(_WIN32)
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#include <fcntl.h>
+#include <io.h>
+
+struct PlatformThread {
+    HANDLE handle;
+    PlatformThreadProc proc;
+    void *userData;
+};
+
+struct PlatformMutex {
+    SRWLOCK lock;
+};
+
+struct PlatformCond {
+    CONDITION_VARIABLE cond;
+};
+
+static DWORD WINAPI PlatformThreadMain(LPVOID param)
+{
+    PlatformThread *thread = param;
+    thread->proc(thread->userData);
+    return 0;
+}
+
+PlatformThread *PlatformThreadStart(PlatformThreadProc proc, void *userData)
+{
+    PlatformThread *thread = calloc(1, sizeof(*thread));
+    thread->proc = proc;
+    thread->userData = userData;
+    thread->handle = CreateThread(0, 0, PlatformThreadMain, thread, 0, 0);
+    if (!thread->handle) {
+        free(thread);
+        return 0;
+    }
+    return thread;
+}
+
+void PlatformThreadJoin(PlatformThread *thread)
+{
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    free(thread);
+}
+
+PlatformMutex *PlatformMutexCreate(void)
+{
+    PlatformMutex *mutex = calloc(1, sizeof(*mutex));
+    InitializeSRWLock(&mutex->lock);
+    return mutex;
+}
+
+void PlatformMutexLock(PlatformMutex *mutex)
+{
+    AcquireSRWLockExclusive(&mutex->lock);
+}
+
+void PlatformMutexUnlock(PlatformMutex *mutex)
+{
+    ReleaseSRWLockExclusive(&mutex->lock);
+}
+
+void PlatformMutexDestroy(PlatformMutex *mutex)
+{
+    free(mutex);
+}
+
+PlatformCond *PlatformCondCreate(void)
+{
+    PlatformCond *cond = calloc(1, sizeof(*cond));
+    InitializeConditionVariable(&cond->cond);
+    return cond;
+}
+
+void PlatformCondWait(PlatformCond *cond, PlatformMutex *mutex)
+{
+    SleepConditionVariableSRW(&cond->cond, &mutex->lock, INFINITE, 0);
+}
+
+void PlatformCondSignal(PlatformCond *cond)
+{
+    WakeConditionVariable(&cond->cond);
+}
+
+void PlatformCondBroadcast(PlatformCond *cond)
+{
+    WakeAllConditionVariable(&cond->cond);
+}
+
+void PlatformCondDestroy(PlatformCond *cond)
+{
+    free(cond);
+}
+
+int PlatformProcessorCount(void)
+{
+    SYSTEM_INFO info = { 0 };
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+}
+
+void *PlatformReserve(size_t size)
+{
+    return VirtualAlloc(0, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool PlatformCommit(void *data, size_t size)
+{
+    return VirtualAlloc(data, size, MEM_COMMIT, PAGE_READWRITE) != 0;
+}
+
+void PlatformRelease(void *data, size_t size)
+{
+    (void)size;
+    VirtualFree(data, 0, MEM_RELEASE);
+}
+
+void *PlatformMapFile(const char *path, size_t *size)
+{
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (file == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+
+    void *data = 0;
+    LARGE_INTEGER fileSize = { 0 };
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+        if (mapping) {
+            data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+
+    *size = data ? (size_t)fileSize.QuadPart : 0;
+    return data;
+}
+
+void PlatformUnmapFile(void *data, size_t size)
+{
+    (void)size;
+    UnmapViewOfFile(data);
+}
+
+static long long PlatformFileTime(const char *path)
+{
+    WIN32_FILE_ATTRIBUTE_DATA info = { 0 };
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info)) {
+        return 0;
+    }
+    return ((long long)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+}
+
+unsigned int PlatformAtomicLoad(volatile unsigned int *value)
+{
+    return (unsigned int)InterlockedCompareExchange((volatile LONG *)value, 0, 0);
+}
+
+void PlatformAtomicStore(volatile unsigned int *value, unsigned int newValue)
+{
+    InterlockedExchange((volatile LONG *)value, (LONG)newValue);
+}
+
+void PlatformFenceAcquire(void)
+{
+    MemoryBarrier();
+}
+
+void PlatformFenceRelease(void)
+{
+    MemoryBarrier();
+}
+
+double PlatformTime(void)
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart / (double)frequency.QuadPart;
+}
+
+bool PlatformMakeDirectory(const char *path)
+{
+    return CreateDirectoryA(path, 0) || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
+void PlatformSetBinaryMode(FILE *file)
+{
+    _setmode(_fileno(file), _O_BINARY);
+}
+
+long long PlatformFileTell(FILE *file)
+{
+    return _ftelli64(file);
+}
+
+bool PlatformFileSeek(FILE *file, long long offset)
+{
+    return !_fseeki64(file, offset, SEEK_SET);
+}
+
+size_t PlatformPeakMemory(void)
+{
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+}
+
+#else
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+struct PlatformThread {
+    pthread_t handle;
+    PlatformThreadProc proc;
+    void *userData;
+};
+
+struct PlatformMutex {
+    pthread_mutex_t lock;
+};
+
+struct PlatformCond {
+    pthread_cond_t cond;
+};
+
+static void *PlatformThreadMain(void *param)
+{
+    PlatformThread *thread = param;
+    thread->proc(thread->userData);
+    return 0;
+}
+
+PlatformThread *PlatformThreadStart(PlatformThreadProc proc, void *userData)
+{
+    PlatformThread *thread = calloc(1, sizeof(*thread));
+    thread->proc = proc;
+    thread->userData = userData;
+    if (pthread_create(&thread->handle, 0, PlatformThreadMain, thread)) {
+        free(thread);
+        return 0;
+    }
+    return thread;
+}
+
+void PlatformThreadJoin(PlatformThread *thread)
+{
+    pthread_join(thread->handle, 0);
+    free(thread);
+}
+
+PlatformMutex *PlatformMutexCreate(void)
+{
+    PlatformMutex *mutex = calloc(1, sizeof(*mutex));
+    pthread_mutex_init(&mutex->lock, 0);
+    return mutex;
+}
+
+void PlatformMutexLock(PlatformMutex *mutex)
+{
+    pthread_mutex_lock(&mutex->lock);
+}
+
+void PlatformMutexUnlock(PlatformMutex *mutex)
+{
+    pthread_mutex_unlock(&mutex->lock);
+}
+
+void PlatformMutexDestroy(PlatformMutex *mutex)
+{
+    pthread_mutex_destroy(&mutex->lock);
+    free(mutex);
+}
+
+PlatformCond *PlatformCondCreate(void)
+{
+    PlatformCond *cond = calloc(1, sizeof(*cond));
+    pthread_cond_init(&cond->cond, 0);
+    return cond;
+}
+
+void PlatformCondWait(PlatformCond *cond, PlatformMutex *mutex)
+{
+    pthread_cond_wait(&cond->cond, &mutex->lock);
+}
+
+void PlatformCondSignal(PlatformCond *cond)
+{
+    pthread_cond_signal(&cond->cond);
+}
+
+void PlatformCondBroadcast(PlatformCond *cond)
+{
+    pthread_cond_broadcast(&cond->cond);
+}
+
+void PlatformCondDestroy(PlatformCond *cond)
+{
+    pthread_cond_destroy(&cond->cond);
+    free(cond);
+}
+
+int PlatformProcessorCount(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+void *PlatformReserve(size_t size)
+{
+    void *data = mmap(0, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return data == MAP_FAILED ? 0 : data;
+}
+
+bool PlatformCommit(void *data, size_t size)
+{
+    return !mprotect(data, size, PROT_READ | PROT_WRITE);
+}
+
+void PlatformRelease(void *data, size_t size)
+{
+    munmap(data, size);
+}
+
+void *PlatformMapFile(const char *path, size_t *size)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    void *data = 0;
+    struct stat info = { 0 };
+    if (!fstat(fd, &info) && info.st_size > 0) {
+        data = mmap(0, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            data = 0;
+        }
+    }
+    close(fd);
+
+    *size = data ? (size_t)info.st_size : 0;
+    return data;
+}
+
+void PlatformUnmapFile(void *data, size_t size)
+{
+    munmap(data, size);
+}
+
+// Only the polling watcher needs this; Linux uses inotify
+#if !defined(__linux__)
+static long long PlatformFileTime(const char *path)
+{
+    struct stat info = { 0 };
+    if (stat(path, &info)) {
+        return 0;
+    }
+    return (long long)info.st_mtime * 1000000000LL + info.st_mtim.tv_nsec;
+}
+#endif
+
+unsigned int PlatformAtomicLoad(volatile unsigned int *value)
+{
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+void PlatformAtomicStore(volatile unsigned int *value, unsigned int newValue)
+{
+    __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+}
+
+void PlatformFenceAcquire(void)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+void PlatformFenceRelease(void)
+{
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+double PlatformTime(void)
+{
+    struct timespec now = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+bool PlatformMakeDirectory(const char *path)
+{
+    return !mkdir(path, 0755) || errno == EEXIST;
+}
+
+void PlatformSetBinaryMode(FILE *file)
+{
+    (void)file;
+}
+
+long long PlatformFileTell(FILE *file)
+{
+    return ftello(file);
+}
+
+bool PlatformFileSeek(FILE *file, long long offset)
+{
+    return !fseeko(file, (off_t)offset, SEEK_SET);
+}
+
+size_t PlatformPeakMemory(void)
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage)) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+#endif
+
+typedef struct {
+    char *path;
+    bool changed;
+#if defined(__linux__)
+    int wd;             // inotify watch of the containing directory
+    const char *name;   // file name within path
+#else
+    long long time;     // last seen modification time
+#endif
+} PlatformWatchedFile;
+
+struct PlatformWatcher {
+    PlatformWatchedFile *files;
+    int fileCount;
+    int fileCapacity;
+#if defined(__linux__)
+    int fd;
+    int wakeFd;         // eventfd that ends PlatformWatcherWait
+#else
+    double lastPoll;
+#endif
+};
+
+#define PLATFORM_WATCH_POLL_SECONDS 0.25
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
+
+PlatformWatcher *PlatformWatcherCreate(void)
+{
+    PlatformWatcher *watcher = calloc(1, sizeof(*watcher));
+#if defined(__linux__)
+    watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    watcher->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (watcher->fd < 0 || watcher->wakeFd < 0) {
+        if (watcher->fd >= 0) close(watcher->fd);
+        if (watcher->wakeFd >= 0) close(watcher->wakeFd);
+        free(watcher);
+        return 0;
+    }
+#endif
+    return watcher;
+}
+
+void PlatformWatcherAdd(PlatformWatcher *watcher, const char *path)
+{
+    for (int i = 0; i < watcher->fileCount; i++) {
+        if (!strcmp(watcher->files[i].path, path)) {
+            return;
+        }
+    }
+    if (watcher->fileCount == watcher->fileCapacity) {
+        int capacity = watcher->fileCapacity ? watcher->fileCapacity * 2 : 16;
+        PlatformWatchedFile *files = realloc(watcher->files, capacity * sizeof(*files));
+        if (!files) {
+            return;
+        }
+        watcher->files = files;
+        watcher->fileCapacity = capacity;
+    }
+
+    PlatformWatchedFile *file = &watcher->files[watcher->fileCount];
+    memset(file, 0, sizeof(*file));
+    size_t length = strlen(path);
+    file->path = malloc(length + 1);
+    if (!file->path) {
+        return;
+    }
+    memcpy(file->path, path, length + 1);
+
+#if defined(__linux__)
+    // Watch the directory: editors often save by writing a new file and
+    // renaming it over the old one, which would end a watch on the file itself
+    const char *slash = strrchr(path, '/');
+    file->name = slash ? file->path + (slash - path) + 1 : file->path;
+    char dir[4096] = ".";
+    if (slash && (size_t)(slash - path) < sizeof(dir)) {
+        memcpy(dir, path, slash - path);
+        dir[slash > path ? slash - path : 1] = 0;
+    }
+    file->wd = inotify_add_watch(watcher->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (file->wd < 0) {
+        free(file->path);
+        return;
+    }
+#else
+    file->time = PlatformFileTime(path);
+#endif
+    watcher->fileCount++;
+}
+
+bool PlatformWatcherPoll(PlatformWatcher *watcher, char *path, size_t size)
+{
+#if defined(__linux__)
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+        ssize_t length = read(watcher->fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+        for (char *c = buffer; c < buffer + length; ) {
+            const struct inotify_event *event = (const struct inotify_event *)c;
+            for (int i = 0; i < watcher->fileCount && event->len; i++) {
+                PlatformWatchedFile *file = &watcher->files[i];
+                if (file->wd == event->wd && !strcmp(file->name, event->name)) {
+                    file->changed = true;
+                }
+            }
+            c += sizeof(*event) + event->len;
+        }
+    }
+#else
+    double now = PlatformTime();
+    if (now - watcher->lastPoll >= PLATFORM_WATCH_POLL_SECONDS) {
+        watcher->lastPoll = now;
+        for (int i = 0; i < watcher->fileCount; i++) {
+            PlatformWatchedFile *file = &watcher->files[i];
+            long long time = PlatformFileTime(file->path);
+            if (time && time != file->time) {
+                file->time = time;
+                file->changed = true;
+            }
+        }
+    }
+#endif
+
+    for (int i = 0; i < watcher->fileCount; i++) {
+        PlatformWatchedFile *file = &watcher->files[i];
+        if (file->changed) {
+            file->changed = false;
+            size_t length = strlen(file->path);
+            if (length >= size) {
+                continue;
+            }
+            memcpy(path, file->path, length + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PlatformWatcherWait(PlatformWatcher *watcher)
+{
+#if defined(__linux__)
+    struct pollfd fds[2] = { { watcher->fd, POLLIN, 0 }, { watcher->wakeFd, POLLIN, 0 } };
+    while (poll(fds, 2, -1) < 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    if (fds[1].revents & POLLIN) {
+        eventfd_t count;
+        eventfd_read(watcher->wakeFd, &count);
+    }
+    return fds[0].revents & POLLIN;
+#else
+    (void)watcher;
+    return false;
+#endif
+}
+
+void PlatformWatcherWake(PlatformWatcher *watcher)
+{
+#if defined(__linux__)
+    eventfd_write(watcher->wakeFd, 1);
+#else
+    (void)watcher;
+#endif
+}
+
+void PlatformWatcherDestroy(PlatformWatcher *watcher)
+{
+    if (!watcher) {
+        return;
+    }
+#if defined(__linux__)
+    close(watcher->fd);
+    close(watcher->wakeFd);
+#endif
+    for (int i = 0; i < watcher->fileCount; i++) {
+        free(watcher->files[i].path);
+    }
+    free(watcher->files);
+    free(watcher);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Thin OS layer for the bits raylib does not cover. Kept out of
+// slideshow.c because windows.h and raylib.h cannot share a translation unit.
+
+typedef struct PlatformThread PlatformThread;
+typedef struct PlatformMutex PlatformMutex;
+typedef struct PlatformCond PlatformCond;
+typedef struct PlatformWatcher PlatformWatcher;
+
+typedef void (*PlatformThreadProc)(void *userData);
+
+#if defined(_MSC_VER)
+#define PLATFORM_THREAD_LOCAL __declspec(thread)
+#else
+#define PLATFORM_THREAD_LOCAL _Thread_local
+#endif
+
+PlatformThread *PlatformThreadStart(PlatformThreadProc proc, void *userData);
+void PlatformThreadJoin(PlatformThread *thread);
+
+PlatformMutex *PlatformMutexCreate(void);
+void PlatformMutexLock(PlatformMutex *mutex);
+void PlatformMutexUnlock(PlatformMutex *mutex);
+void PlatformMutexDestroy(PlatformMutex *mutex);
+
+PlatformCond *PlatformCondCreate(void);
+void PlatformCondWait(PlatformCond *cond, PlatformMutex *mutex);
+void PlatformCondSignal(PlatformCond *cond);
+void PlatformCondBroadcast(PlatformCond *cond);
+void PlatformCondDestroy(PlatformCond *cond);
+
+int PlatformProcessorCount(void);
+
+// Acquire load and release store, for single-writer data read by other threads
+unsigned int PlatformAtomicLoad(volatile unsigned int *value);
+void PlatformAtomicStore(volatile unsigned int *value, unsigned int newValue);
+// Order plain reads before later loads (acquire), or earlier stores before
+// later plain writes (release), as a seqlock's reader and writer need
+void PlatformFenceAcquire(void);
+void PlatformFenceRelease(void);
+
+// Monotonic seconds. Unlike GetTime this works without a raylib window.
+double PlatformTime(void);
+
+// Create a directory, succeeding if it already exists
+bool PlatformMakeDirectory(const char *path);
+
+// Stop the C runtime translating line endings in a stream (e.g. stdout)
+void PlatformSetBinaryMode(FILE *file);
+
+// 64-bit stream positions: ftell/fseek take a long, which is 32-bit on
+// Windows. Seek is from the start of the file and returns whether it worked.
+long long PlatformFileTell(FILE *file);
+bool PlatformFileSeek(FILE *file, long long offset);
+
+// Peak resident memory of the process in bytes, 0 if unknown
+size_t PlatformPeakMemory(void);
+
+// Reserve address space without backing memory, then commit pages of it as
+// needed. Committed pages start zeroed. Release frees the whole reservation.
+void *PlatformReserve(size_t size);
+bool PlatformCommit(void *data, size_t size);
+void PlatformRelease(void *data, size_t size);
+
+// Map a whole file copy-on-write: pages are shared with the file until first
+// written, writes are private to the process and never reach the file.
+void *PlatformMapFile(const char *path, size_t *size);
+void PlatformUnmapFile(void *data, size_t size);
+
+// Report files that were written or replaced. Uses inotify on Linux (watching
+// the containing directories, so editors that save by renaming still count)
+// and polls modification times elsewhere.
+PlatformWatcher *PlatformWatcherCreate(void);
+void PlatformWatcherAdd(PlatformWatcher *watcher, const char *path);
+bool PlatformWatcherPoll(PlatformWatcher *watcher, char *path, size_t size);  // one changed path per call
+// Block until a watched file may have changed (true) or until another thread
+// calls PlatformWatcherWake (false). Linux only: elsewhere there is nothing to
+// block on, Wait returns false at once and changes are found by polling.
+bool PlatformWatcherWait(PlatformWatcher *watcher);
+void PlatformWatcherWake(PlatformWatcher *watcher);
+void PlatformWatcherDestroy(PlatformWatcher *watcher);
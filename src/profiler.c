@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include <string.h>
+#include "slideshow.h"
+
+// Frame time profiler. The main loop brackets each phase of a redrawn frame
+// with ProfilerPhaseBegin/End; the overlay in the header shows frame time
+// percentiles and mean phase times over the history, next to a graph of the
+// last PROFILER_HISTORY frames with every bar split into its phases.
+//
+// While the overlay is visible the player redraws continuously instead of
+// idling, so the numbers describe steady-state frames rather than waits for
+// input. The phases are also recorded as trace events.
+//
+// The main loop's frame counters live here too, with the test for whether
+// a frame needs drawing at all, so the bench can drive and check it.
+
+Profiler profiler;
+FrameStats frameStats = { .last = { .slide = -1 } };
+
+static const char *phaseNames[Phase_Count] = { "in", "lay", "rows", "foot", "swap" };
+static const char *phaseTraceNames[Phase_Count] = { "Input", "Layout", "RowDraw", "Footer", "EndDrawing" };
+static const Color phaseColors[Phase_Count] = { GREEN, YELLOW, ORANGE, PURPLE, SKYBLUE };
+
+void FrameStatsReset(void)
+{
+    frameStats = (FrameStats){ .last = { .slide = -1 } };
+}
+
+// Count a frame of the main loop and decide whether to draw it. An idle
+// frame is skipped when its state is the same as the last drawn one's.
+bool FrameRedraw(const FrameState *frame, bool idle)
+{
+    frameStats.frames++;
+    if (idle && !memcmp(frame, &frameStats.last, sizeof(*frame))) {
+        return false;
+    }
+    frameStats.last = *frame;
+    frameStats.redraws++;
+    return true;
+}
+
+void ProfilerFrameBegin(void)
+{
+    TRACE_BEGIN("Frame");
+    profiler.frameStart = GetTime();
+    memset(profiler.current, 0, sizeof(profiler.current));
+}
+
+void ProfilerPhaseBegin(ProfilePhase phase)
+{
+    TRACE_BEGIN(phaseTraceNames[phase]);
+    profiler.phaseStart[phase] = GetTime();
+}
+
+void ProfilerPhaseEnd(ProfilePhase phase)
+{
+    profiler.current[phase] += (float)((GetTime() - profiler.phaseStart[phase]) * 1000.0);
+    TRACE_END(phaseTraceNames[phase]);
+}
+
+void ProfilerFrameEnd(void)
+{
+    ProfileFrame *frame = &profiler.history[profiler.head];
+    frame->total = (float)((GetTime() - profiler.frameStart) * 1000.0);
+    memcpy(frame->phases, profiler.current, sizeof(frame->phases));
+    profiler.head = (profiler.head + 1) % PROFILER_HISTORY;
+    if (profiler.count < PROFILER_HISTORY) {
+        profiler.count++;
+    }
+    TRACE_END("Frame");
+}
+
+static int ProfilerCompare(const void *a, const void *b)
+{
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+// Draw the overlay right-aligned in the header bar
+void ProfilerDraw(Rectangle header)
+{
+    if (!profiler.count) {
+        return;
+    }
+
+    float sorted[PROFILER_HISTORY];
+    float mean[Phase_Count] = { 0 };
+    for (int i = 0; i < profiler.count; i++) {
+        sorted[i] = profiler.history[i].total;
+        for (int p = 0; p < Phase_Count; p++) {
+            mean[p] += profiler.history[i].phases[p] / profiler.count;
+        }
+    }
+    qsort(sorted, profiler.count, sizeof(*sorted), ProfilerCompare);
+    const float p50 = sorted[profiler.count / 2];
+    const float p95 = sorted[profiler.count * 95 / 100];
+    const float p99 = sorted[profiler.count * 99 / 100];
+
+    // Graph: one column per frame, newest on the right, full height at two
+    // 60 Hz frames, with a tick at one
+    const float msHeight = header.height / 33.3f;
+    const float graphX = header.x + header.width - PROFILER_HISTORY - 4;
+    const int oldest = (profiler.head - profiler.count + PROFILER_HISTORY) % PROFILER_HISTORY;
+    const float bottom = header.y + header.height;
+    DrawRectangle((int)graphX, (int)header.y, PROFILER_HISTORY, (int)header.height, ColorAlpha(BLACK, 0.5f));
+    for (int i = 0; i < profiler.count; i++) {
+        const ProfileFrame *frame = &profiler.history[(oldest + i) % PROFILER_HISTORY];
+        const float x = graphX + PROFILER_HISTORY - profiler.count + i;
+        float y = bottom;
+        float phaseTotal = 0;
+        for (int p = 0; p < Phase_Count; p++) {
+            float height = frame->phases[p] * msHeight;
+            if (y - height < header.y) height = y - header.y;
+            DrawRectangleRec((Rectangle){ x, y - height, 1, height }, phaseColors[p]);
+            y -= height;
+            phaseTotal += frame->phases[p];
+        }
+        // Time outside the phases (uploads, cache updates, header)
+        float height = (frame->total - phaseTotal) * msHeight;
+        if (y - height < header.y) height = y - header.y;
+        DrawRectangleRec((Rectangle){ x, y - height, 1, height }, GRAY);
+    }
+    DrawLineV((Vector2){ graphX, bottom - 16.7f * msHeight }, (Vector2){ graphX + PROFILER_HISTORY, bottom - 16.7f * msHeight }, RED);
+
+    // Text, right to left so each part lands just before the previous one
+    BeginShaderMode(fontShader);
+    float x = graphX - 8;
+    for (int p = Phase_Count - 1; p >= 0; p--) {
+        const char *text = TextFormat("%s %.2f", phaseNames[p], mean[p]);
+        x -= TextLineWidth(text, UI_FONT_SIZE, 1.0f);
+        DrawTextLine(text, (int)strlen(text), (Vector2){ x, header.y }, UI_FONT_SIZE, 1.0f, phaseColors[p]);
+        x -= 8;
+    }
+    const char *text = TextFormat("p50 %.1f p95 %.1f p99 %.1f ms", p50, p95, p99);
+    x -= TextLineWidth(text, UI_FONT_SIZE, 1.0f) + 8;
+    DrawTextLine(text, (int)strlen(text), (Vector2){ x, header.y }, UI_FONT_SIZE, 1.0f, WHITE);
+    EndShaderMode();
+}
@@ -1,62 +1,500 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
-#include "raylib/raylib.h"
-
-Font font16;
-Font font24;
-Font font36;
-
-#define MAX_ROWS 8
-#define MAX_SLIDES 64
-
-typedef enum {
-    Row_Empty,
-    Row_Text,
-    Row_Image
-} RowType;
-
-typedef struct {
-    Font font;
-    const char *text;
-} RowText;
-
-typedef struct {
-    Texture texture;
-} RowImage;
-
-typedef struct {
-    float percent;  // 0 = fixed pixels, >0 = percent, <0 = dynamic fill
-    Vector2 pixels;
-    Vector2 actual;
-} RowSize;
-
-typedef struct {
-    RowType type;
-    RowSize size;
-    union {
-        RowText text;
-        RowImage image;
-    };
-} Row;
+#include "slideshow.h"
+
+ImageAsset *images;
+int imageCount;
+unsigned int imageGeneration;
+
+// The image table is an arena, so loader threads can keep using entries
+// while the main thread registers more
+static Arena imageStore;
 
-typedef struct {
-    int rowCount;
-    Row rows[MAX_ROWS];
-} Slide;
+// Open-addressed table of image index + 1 by path hash, 0 for empty, kept
+// at most half full
+static int *imageLookup;
+static int imageLookupSize;
+ImageLoader loader;
+TextureCache textureCache = {
+    .budget = DEFAULT_TEXTURE_BUDGET_MB * 1024LL * 1024LL,
+    .prefetchSlides = DEFAULT_PREFETCH_SLIDES,
+    .slide = -1
+};
 
-Slide slides[MAX_SLIDES];
+SlideStore slideStore;
+Slide *slides;
 
 int slideCount;
 int slide;
 
+// Never keep more pixels than can be drawn. ImageResize uses
+// stb_image_resize2, which filters with Mitchell/Catmull-Rom and is
+// SIMD-accelerated.
+void ImageFit(Image *image, int maxWidth, int maxHeight)
+{
+    if (image->data && maxWidth && maxHeight && (image->width > maxWidth || image->height > maxHeight)) {
+        float scale = fminf(maxWidth / (float)image->width, maxHeight / (float)image->height);
+        int width = (int)ceilf(image->width * scale);
+        int height = (int)ceilf(image->height * scale);
+        ImageResize(image, width > 0 ? width : 1, height > 0 ? height : 1);
+    }
+}
+
+void LoaderThread(void *userData)
+{
+    (void)userData;
+    TraceThreadName("loader");
+    PlatformMutexLock(loader.mutex);
+    for (;;) {
+        while (!loader.quit && !loader.queueCount) {
+            PlatformCondWait(loader.wake, loader.mutex);
+        }
+        if (loader.quit) {
+            break;
+        }
+
+        int index = loader.queue[loader.queueHead];
+        loader.queueHead = (loader.queueHead + 1) % loader.capacity;
+        loader.queueCount--;
+        const int maxWidth = images[index].maxWidth;
+        const int maxHeight = images[index].maxHeight;
+        PlatformMutexUnlock(loader.mutex);
+
+        TRACE_BEGIN_ARG("DecodeImage", index);
+        Image image = LoadImage(images[index].path);
+        const int nativeWidth = image.width;
+        const int nativeHeight = image.height;
+
+        ImageFit(&image, maxWidth, maxHeight);
+        TRACE_END("DecodeImage");
+
+        PlatformMutexLock(loader.mutex);
+        images[index].image = image;
+        images[index].decodedWidth = nativeWidth;
+        images[index].decodedHeight = nativeHeight;
+        images[index].state = Image_Decoded;
+        loader.decoded[(loader.decodedHead + loader.decodedCount) % loader.capacity] = index;
+        loader.decodedCount++;
+    }
+    PlatformMutexUnlock(loader.mutex);
+}
+
+void LoaderInit(void)
+{
+    loader.mutex = PlatformMutexCreate();
+    loader.wake = PlatformCondCreate();
+
+    int threadCount = PlatformProcessorCount() - 1;
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > MAX_LOADER_THREADS) threadCount = MAX_LOADER_THREADS;
+    for (int i = 0; i < threadCount; i++) {
+        loader.threads[loader.threadCount] = PlatformThreadStart(LoaderThread, 0);
+        if (loader.threads[loader.threadCount]) {
+            loader.threadCount++;
+        }
+    }
+}
+
+void LoaderShutdown(void)
+{
+    PlatformMutexLock(loader.mutex);
+    loader.quit = true;
+    PlatformCondBroadcast(loader.wake);
+    PlatformMutexUnlock(loader.mutex);
+
+    for (int i = 0; i < loader.threadCount; i++) {
+        PlatformThreadJoin(loader.threads[i]);
+    }
+    PlatformCondDestroy(loader.wake);
+    PlatformMutexDestroy(loader.mutex);
+    free(loader.queue);
+    free(loader.decoded);
+    loader = (ImageLoader){ 0 };
+    ImagesUnload();
+}
+
+// Free every registered image's pixels and texture and forget the images
+void ImagesUnload(void)
+{
+    for (int i = 0; i < imageCount; i++) {
+        if (images[i].image.data != images[i].packed.data) {
+            UnloadImage(images[i].image);
+        }
+        UnloadTexture(images[i].texture);
+        MemFree(images[i].path);
+    }
+    ArenaRelease(&imageStore);
+    images = 0;
+    imageCount = 0;
+    free(imageLookup);
+    imageLookup = 0;
+    imageLookupSize = 0;
+}
+
+// FNV-1a
+static unsigned int ImagePathHash(const char *path)
+{
+    unsigned int hash = 2166136261u;
+    for (const unsigned char *c = (const unsigned char *)path; *c; c++) {
+        hash = (hash ^ *c) * 16777619u;
+    }
+    return hash;
+}
+
+static unsigned int ImageLookupSlot(const char *path)
+{
+    unsigned int slot = ImagePathHash(path) % imageLookupSize;
+    while (imageLookup[slot] && strcmp(images[imageLookup[slot] - 1].path, path)) {
+        slot = (slot + 1) % imageLookupSize;
+    }
+    return slot;
+}
+
+// Double the lookup table and hash every image into it again
+static bool ImageLookupGrow(void)
+{
+    const int oldSize = imageLookupSize;
+    int *oldLookup = imageLookup;
+    const int size = oldSize ? 2 * oldSize : 1024;
+    int *lookup = calloc(size, sizeof(*lookup));
+    if (!lookup) {
+        return false;
+    }
+    imageLookup = lookup;
+    imageLookupSize = size;
+    for (int i = 0; i < oldSize; i++) {
+        if (oldLookup[i]) {
+            imageLookup[ImageLookupSlot(images[oldLookup[i] - 1].path)] = oldLookup[i];
+        }
+    }
+    free(oldLookup);
+    return true;
+}
+
+// Returns the index of the image for path, or -1 without memory for it.
+// Nothing is loaded until the texture cache asks for it.
+int ImageRegister(const char *path)
+{
+    if (imageLookupSize) {
+        const int found = imageLookup[ImageLookupSlot(path)];
+        if (found) {
+            return found - 1;
+        }
+    }
+    if (2 * (imageCount + 1) > imageLookupSize && !ImageLookupGrow()) {
+        return -1;
+    }
+
+    size_t length = strlen(path);
+    char *copy = MemAlloc((unsigned int)length + 1);
+    ImageAsset *image = ArenaPush(&imageStore, sizeof(ImageAsset), sizeof(void *));
+    if (!copy || !image) {
+        MemFree(copy);
+        return -1;
+    }
+    memset(image, 0, sizeof(*image));
+    memcpy(copy, path, length + 1);
+    image->path = copy;
+    images = (ImageAsset *)imageStore.base;
+    const int index = imageCount++;
+    imageLookup[ImageLookupSlot(path)] = index + 1;
+    return index;
+}
+
+// The loader's lock, for image state that is also touched outside the
+// player. Without LoaderInit (the headless export, the benchmark) there are
+// no loader threads to race with and no lock.
+static void LoaderLock(void)
+{
+    if (loader.mutex) {
+        PlatformMutexLock(loader.mutex);
+    }
+}
+
+static void LoaderUnlock(void)
+{
+    if (loader.mutex) {
+        PlatformMutexUnlock(loader.mutex);
+    }
+}
+
+// Use pixels that are already decoded and scaled (e.g. in a mapped deck pack)
+// instead of decoding the file. width/height are the native image size.
+void ImageAttachPacked(int index, Image pixels, int width, int height)
+{
+    ImageAsset *image = &images[index];
+    LoaderLock();
+    image->packed = pixels;
+    image->width = width;
+    image->height = height;
+    if (pixels.width > image->maxWidth) image->maxWidth = pixels.width;
+    if (pixels.height > image->maxHeight) image->maxHeight = pixels.height;
+    LoaderUnlock();
+}
+
+// Forget pixels in a deck pack that is about to be unmapped. Images still
+// waiting for upload from the pack are dropped.
+void ImagesDetachPacked(void)
+{
+    LoaderLock();
+    for (int i = 0; i < imageCount; i++) {
+        ImageAsset *image = &images[i];
+        if (image->packed.data && image->image.data == image->packed.data) {
+            image->image = (Image){ 0 };
+        }
+        image->packed = (Image){ 0 };
+    }
+    LoaderUnlock();
+}
+
+// Make both rings as long as the image table, the queued and decoded images
+// moved to the front. Under the loader's lock.
+static bool LoaderRingsGrow(void)
+{
+    int capacity = loader.capacity ? loader.capacity : 64;
+    while (capacity < imageCount) {
+        capacity *= 2;
+    }
+    int *queue = malloc(capacity * sizeof(*queue));
+    int *decoded = malloc(capacity * sizeof(*decoded));
+    if (!queue || !decoded) {
+        free(queue);
+        free(decoded);
+        return false;
+    }
+    for (int i = 0; i < loader.queueCount; i++) {
+        queue[i] = loader.queue[(loader.queueHead + i) % loader.capacity];
+    }
+    for (int i = 0; i < loader.decodedCount; i++) {
+        decoded[i] = loader.decoded[(loader.decodedHead + i) % loader.capacity];
+    }
+    free(loader.queue);
+    free(loader.decoded);
+    loader.queue = queue;
+    loader.decoded = decoded;
+    loader.queueHead = 0;
+    loader.decodedHead = 0;
+    loader.capacity = capacity;
+    return true;
+}
+
+// Queue an image for decode at up to maxWidth x maxHeight. Urgent requests
+// (the slide on screen) jump ahead of prefetches, including a prefetch of
+// the same image that is still waiting. Unloaded images are always queued;
+// resident ones only when reload is set, e.g. because they are now drawn
+// larger than their downscaled texture. The old texture stays in use until
+// the new one is uploaded. Returns whether the image was queued, or was
+// already queued and the request is urgent, i.e. it is not there yet.
+bool LoaderQueue(int index, int maxWidth, int maxHeight, bool urgent, bool reload)
+{
+    bool queued = false;
+    PlatformMutexLock(loader.mutex);
+    if (loader.capacity < imageCount && !LoaderRingsGrow()) {
+        PlatformMutexUnlock(loader.mutex);
+        TraceLog(LOG_WARNING, "IMAGE: Out of memory for the loader queue");
+        return false;
+    }
+    ImageAsset *image = &images[index];
+    if (image->state == Image_Unloaded || image->state == Image_Ready) {
+        if (maxWidth > image->maxWidth) image->maxWidth = maxWidth;
+        if (maxHeight > image->maxHeight) image->maxHeight = maxHeight;
+    }
+    if (image->state == Image_Unloaded && image->packed.data && !reload) {
+        // Already decoded and scaled in the mapped deck pack, straight to upload
+        image->state = Image_Decoded;
+        image->image = image->packed;
+        image->decodedWidth = image->width;
+        image->decodedHeight = image->height;
+        loader.decoded[(loader.decodedHead + loader.decodedCount) % loader.capacity] = index;
+        loader.decodedCount++;
+        loader.pending++;
+        queued = true;
+    } else if (image->state == Image_Unloaded || (reload && image->state == Image_Ready)) {
+        image->state = Image_Queued;
+        if (urgent) {
+            loader.queueHead = (loader.queueHead + loader.capacity - 1) % loader.capacity;
+            loader.queue[loader.queueHead] = index;
+        } else {
+            loader.queue[(loader.queueHead + loader.queueCount) % loader.capacity] = index;
+        }
+        loader.queueCount++;
+        loader.pending++;
+        PlatformCondSignal(loader.wake);
+        queued = true;
+    } else if (urgent && image->state == Image_Queued) {
+        // Move it to the front, unless a loader thread already took it
+        for (int i = 0; i < loader.queueCount; i++) {
+            if (loader.queue[(loader.queueHead + i) % loader.capacity] != index) {
+                continue;
+            }
+            for (; i > 0; i--) {
+                loader.queue[(loader.queueHead + i) % loader.capacity] = loader.queue[(loader.queueHead + i - 1) % loader.capacity];
+            }
+            loader.queue[loader.queueHead] = index;
+            break;
+        }
+        queued = true;
+    }
+    PlatformMutexUnlock(loader.mutex);
+    return queued;
+}
+
+// Upload decoded images to the GPU until the per-frame budget is spent.
+// Main thread only.
+void LoaderUpload(double budget)
+{
+    const double start = GetTime();
+    do {
+        PlatformMutexLock(loader.mutex);
+        if (!loader.decodedCount) {
+            PlatformMutexUnlock(loader.mutex);
+            break;
+        }
+        int index = loader.decoded[loader.decodedHead];
+        loader.decodedHead = (loader.decodedHead + 1) % loader.capacity;
+        loader.decodedCount--;
+        PlatformMutexUnlock(loader.mutex);
+
+        ImageAsset *image = &images[index];
+        ImageState state = image->texture.id ? Image_Ready : Image_Failed;
+        if (image->image.data) {
+            TRACE_BEGIN_ARG("LoadTexture", index);
+            Texture texture = LoadTextureFromImage(image->image);
+            TRACE_END("LoadTexture");
+            if (texture.id) {
+                if (image->texture.id) {
+                    UnloadTexture(image->texture);
+                    textureCache.used -= image->bytes;
+                }
+                state = Image_Ready;
+                image->texture = texture;
+                image->width = image->decodedWidth;
+                image->height = image->decodedHeight;
+                image->bytes = GetPixelDataSize(texture.width, texture.height, texture.format);
+                textureCache.used += image->bytes;
+            }
+        }
+        if (image->image.data != image->packed.data) {
+            UnloadImage(image->image);
+        }
+        image->image = (Image){ 0 };
+
+        PlatformMutexLock(loader.mutex);
+        image->state = state;
+        loader.pending--;
+        const bool stale = image->stale;
+        image->stale = false;
+        PlatformMutexUnlock(loader.mutex);
+        imageGeneration++;
+
+        if (stale) {
+            ImageReload(index);
+        }
+    } while (GetTime() - start < budget);
+}
+
+// The file behind an image changed on disk: decode it again. The old texture
+// stays on screen until the new one is uploaded. Main thread only.
+void ImageReload(int index)
+{
+    ImageAsset *image = &images[index];
+    PlatformMutexLock(loader.mutex);
+    const bool resident = image->state == Image_Ready;
+    if (image->state == Image_Queued || image->state == Image_Decoded) {
+        // The loader may already have read the old file
+        image->stale = true;
+    } else if (image->state == Image_Failed) {
+        image->state = Image_Unloaded;
+    }
+    PlatformMutexUnlock(loader.mutex);
+
+    if (resident) {
+        LoaderQueue(index, 0, 0, true, true);
+    }
+    textureCache.slide = -1;
+}
+
+int LoaderPending(void)
+{
+    PlatformMutexLock(loader.mutex);
+    int pending = loader.pending;
+    PlatformMutexUnlock(loader.mutex);
+    return pending;
+}
+
+void *ArenaPush(Arena *arena, size_t size, size_t align)
+{
+    if (!arena->base) {
+        arena->base = PlatformReserve(ARENA_RESERVE);
+        if (!arena->base) {
+            return 0;
+        }
+        arena->reserved = ARENA_RESERVE;
+    }
+
+    size_t offset = (arena->used + align - 1) & ~(align - 1);
+    if (offset > arena->reserved || size > arena->reserved - offset) {
+        return 0;
+    }
+    if (offset + size > arena->committed) {
+        size_t commit = (offset + size - arena->committed + ARENA_COMMIT - 1) & ~(ARENA_COMMIT - 1);
+        if (commit > arena->reserved - arena->committed) {
+            commit = arena->reserved - arena->committed;
+        }
+        if (!PlatformCommit(arena->base + arena->committed, commit)) {
+            return 0;
+        }
+        arena->committed += commit;
+    }
+
+    arena->used = offset + size;
+    return arena->base + offset;
+}
+
+void ArenaRelease(Arena *arena)
+{
+    if (arena->base) {
+        PlatformRelease(arena->base, arena->reserved);
+    }
+    *arena = (Arena){ 0 };
+}
+
 Row *PushRow(Slide *slide, RowType type)
 {
-    if (slide->rowCount >= MAX_ROWS) {
+    // A slide's rows must stay contiguous. If rows of another slide were
+    // pushed since this slide's last one, move its rows to the end first.
+    Arena *arena = &slideStore.rows;
+    Row *row = 0;
+    if (slide->rowCount && (unsigned char *)(slide->rows + slide->rowCount) == arena->base + arena->used) {
+        row = ArenaPush(arena, sizeof(Row), sizeof(void *));
+    } else {
+        Row *rows = ArenaPush(arena, (slide->rowCount + 1) * sizeof(Row), sizeof(void *));
+        if (rows) {
+            if (slide->rowCount) {
+                memcpy(rows, slide->rows, slide->rowCount * sizeof(Row));
+            }
+            slide->rows = rows;
+            row = &rows[slide->rowCount];
+        }
+    }
+    if (!row) {
         return 0;
     }
 
-    Row *row = &slide->rows[slide->rowCount++];
+    // Arena memory is only zero when first committed; a reload that failed
+    // hands its rows back for reuse
+    memset(row, 0, sizeof(*row));
+    slide->rowCount++;
     row->type = type;
+    slide->generation++;
+    if (type == Row_Text) {
+        slide->summary |= SLIDE_SUMMARY_TEXT;
+    } else if (type == Row_Image) {
+        slide->summary |= SLIDE_SUMMARY_IMAGE;
+    }
+    slideStore.summariesStale = true;
     return row;
 }
 
@@ -73,124 +511,504 @@ Row *PushRowEmpty(Slide *slide, float pctHeight)
     return row;
 }
 
-Row *PushRowText(Slide *slide, Font font, const char *text, float pctHeight)
+// Measure every line and the size of the whole text block at the row's size
+void RowTextMeasure(Row *row)
+{
+    RowText *text = &row->text;
+    const float fontSize = text->fontSize * fontScale;
+    float width = 0;
+    for (int i = 0; i < text->lineCount; i++) {
+        RowTextLine *line = &text->lines[i];
+        line->width = TextLineWidth(text->lineBuffer + line->offset, fontSize, 1.0f);
+        if (line->width > width) {
+            width = line->width;
+        }
+    }
+    row->size.pixels = (Vector2){ width, text->lineCount * fontSize };
+    text->measureSize = fontSize;
+    text->wrapWidth = -1;
+    text->centerWidth = 0;
+}
+
+// Bytes of the line buffer up to the last line's terminator
+static size_t RowTextBufferSize(const RowText *text)
+{
+    size_t size = 1;
+    for (int l = 0; l < text->lineCount; l++) {
+        if ((size_t)(text->lines[l].offset + text->lines[l].length + 1) > size) {
+            size = text->lines[l].offset + text->lines[l].length + 1;
+        }
+    }
+    return size;
+}
+
+// A pushed row is laid out unwrapped until its first layout needs more
+static void RowTextWrapInit(RowText *text, int wrapCapacity)
+{
+    text->wrapCapacity = wrapCapacity;
+    text->wrapped = text->lines;
+    text->wrappedCount = text->lineCount;
+    text->wrapWidth = -1;
+    text->fitWidth = -1;
+}
+
+// Room for the wrapped lines, which can break at every space, and for the
+// advance sums. Allocated by the first layout that wraps or fits the row, so
+// loading a deck costs nothing per byte of text and only rows that are shown
+// take the memory. Main thread only: the export allocates every row's up
+// front with SlidesWrapAlloc before its workers lay slides out.
+static bool RowTextWrapAlloc(RowText *text)
+{
+    if (text->wrapBuffer) {
+        return true;
+    }
+    RowTextLine *wrapBuffer = ArenaPush(&slideStore.data, (text->wrapCapacity + 1) * sizeof(RowTextLine), sizeof(float));
+    Vector2 *advances = ArenaPush(&slideStore.data, RowTextBufferSize(text) * sizeof(Vector2), sizeof(float));
+    if (!wrapBuffer || !advances) {
+        return false;
+    }
+    text->wrapBuffer = wrapBuffer;
+    text->advances = advances;
+    text->advancesReady = false;
+    return true;
+}
+
+// Every text row's wrap buffers, for laying slides out on several threads
+bool SlidesWrapAlloc(void)
+{
+    for (int i = 0; i < slideCount; i++) {
+        for (int r = 0; r < slides[i].rowCount; r++) {
+            Row *row = &slides[i].rows[r];
+            if (row->type == Row_Text && !RowTextWrapAlloc(&row->text)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Running sums of each line's glyph advances in font units (x) and of its
+// glyph count (y), by byte offset. They do not depend on the font size, so
+// the width of bytes [a, b) of a line at any size is a subtraction, see
+// RowTextSpan.
+static void RowTextAdvances(RowText *text)
+{
+    for (int l = 0; l < text->lineCount; l++) {
+        const RowTextLine *line = &text->lines[l];
+        const char *bytes = text->lineBuffer + line->offset;
+        Vector2 *sum = text->advances + line->offset;
+        Vector2 total = { 0, 0 };
+        for (int i = 0; i < line->length;) {
+            int size = 0;
+            const int index = FontGlyphIndex(GetCodepointNext(&bytes[i], &size));
+            for (int k = 0; k < size && i + k < line->length; k++) {
+                sum[i + k] = total;
+            }
+            total.x += FontGlyphAdvance(index, 1.0f);
+            total.y += 1;
+            i += size;
+        }
+        sum[line->length] = total;
+    }
+    text->advancesReady = true;
+}
+
+// Width of bytes [a, b) of a line as TextLineWidth measures it, scale being
+// the font size over font.baseSize
+static float RowTextSpan(const Vector2 *sum, int a, int b, float scale)
+{
+    const float glyphs = sum[b].y - sum[a].y;
+    return glyphs ? (sum[b].x - sum[a].x) * scale + (glyphs - 1) * 1.0f : 0;
+}
+
+// Break the lines greedily at spaces so each takes as many words as fit in
+// width, a single word wider than that staying whole. Writes the pieces to
+// out unless it is null, up to the row's wrap capacity (a pack's is not
+// checked against its text), and returns how many there are and the widest.
+static int RowTextBreak(const RowText *text, int width, float scale, RowTextLine *out, float *widest)
+{
+    int count = 0;
+    *widest = 0;
+    for (int l = 0; l < text->lineCount; l++) {
+        const RowTextLine *line = &text->lines[l];
+        const char *bytes = text->lineBuffer + line->offset;
+        const Vector2 *sum = text->advances + line->offset;
+        int start = 0;
+        do {
+            // Furthest space (or the line end) the words from start fit up to
+            int end = start;
+            for (int i = start; i <= line->length; i++) {
+                if (i < line->length && bytes[i] != ' ') {
+                    continue;
+                }
+                const bool over = RowTextSpan(sum, start, i, scale) > width;
+                if (over && end > start) {
+                    break;
+                }
+                end = i;
+                if (over) {
+                    break;
+                }
+            }
+
+            const float pieceWidth = RowTextSpan(sum, start, end, scale);
+            if (pieceWidth > *widest) {
+                *widest = pieceWidth;
+            }
+            if (out && count <= text->wrapCapacity) {
+                out[count] = (RowTextLine){ line->offset + start, end - start, pieceWidth, 0 };
+            }
+            count++;
+
+            start = end;
+            while (start < line->length && bytes[start] == ' ') {
+                start++;
+            }
+        } while (start < line->length);
+    }
+    return count;
+}
+
+// Wrap the lines measured at measureSize to width. Cached until the width
+// or the measured size changes.
+void RowTextWrap(Row *row, int width)
+{
+    RowText *text = &row->text;
+    if (text->wrapWidth == width) {
+        return;
+    }
+    text->wrapWidth = width;
+    text->centerWidth = 0;
+
+    float widest = 0;
+    for (int l = 0; l < text->lineCount; l++) {
+        if (text->lines[l].width > widest) {
+            widest = text->lines[l].width;
+        }
+    }
+    if (widest <= width || !RowTextWrapAlloc(text)) {
+        text->wrapped = text->lines;
+        text->wrappedCount = text->lineCount;
+        row->size.pixels = (Vector2){ widest, text->lineCount * text->measureSize };
+        return;
+    }
+    if (!text->advancesReady) {
+        RowTextAdvances(text);
+    }
+    text->wrapped = text->wrapBuffer;
+    text->wrappedCount = RowTextBreak(text, width, text->measureSize / font.baseSize, text->wrapBuffer, &widest);
+    if (text->wrappedCount > text->wrapCapacity + 1) {
+        text->wrappedCount = text->wrapCapacity + 1;
+    }
+    row->size.pixels = (Vector2){ widest, text->wrappedCount * text->measureSize };
+}
+
+// For a fit row, the largest whole font size at which the wrapped text fits
+// width by height, found by a binary search over sizes (the wrapped height
+// only grows with the size), then measure and wrap at it. The result is kept
+// until the row is laid out in a different size, so only the slides that
+// are shown after a resize search again.
+void RowTextFit(Row *row, int width, int height)
+{
+    RowText *text = &row->text;
+    if ((text->fitWidth == width && text->fitHeight == height) || !RowTextWrapAlloc(text)) {
+        return;
+    }
+    if (!text->advancesReady) {
+        RowTextAdvances(text);
+    }
+
+    // Text that does not fit even at the smallest size overflows at it
+    int low = TEXT_FIT_MIN_SIZE;
+    int high = height;
+    while (low < high) {
+        const int size = (low + high + 1) / 2;
+        float widest = 0;
+        const int count = RowTextBreak(text, width, (float)size / font.baseSize, 0, &widest);
+        if (count * size <= height && widest <= width) {
+            low = size;
+        } else {
+            high = size - 1;
+        }
+    }
+
+    text->measureSize = (float)low;
+    const float scale = text->measureSize / font.baseSize;
+    for (int l = 0; l < text->lineCount; l++) {
+        RowTextLine *line = &text->lines[l];
+        line->width = RowTextSpan(text->advances + line->offset, 0, line->length, scale);
+    }
+    text->wrapWidth = -1;
+    RowTextWrap(row, width);
+    text->fitWidth = width;
+    text->fitHeight = height;
+}
+
+void RowTextCenter(Row *row, int width)
+{
+    RowText *text = &row->text;
+    for (int i = 0; i < text->wrappedCount; i++) {
+        RowTextLine *line = &text->wrapped[i];
+        line->x = floorf(width / 2.0f - line->width / 2.0f);
+    }
+    text->centerWidth = width;
+    text->meshStale = true;
+}
+
+Row *PushRowText(Slide *slide, float fontSize, const char *text, float pctHeight)
 {
     Row *row = PushRow(slide, Row_Text);
     if (!row) {
         return 0;
     }
 
-    row->size.pixels = MeasureTextEx(font, text, (float)font.baseSize, 1.0f);
+    // Split into lines once, so drawing never has to format or measure substrings
+    int textLength = (int)strlen(text);
+    int lineCount = 0;
+    int spaces = 0;
+    for (int i = 0; i < textLength; i++) {
+        if (text[i] == '\n') {
+            lineCount++;
+        } else if (text[i] == ' ') {
+            spaces++;
+        }
+    }
+    if (textLength && text[textLength - 1] != '\n') {
+        lineCount++;
+    }
+
+    row->text.lineBuffer = ArenaPush(&slideStore.data, textLength + 1, 1);
+    row->text.lines = ArenaPush(&slideStore.data, lineCount * sizeof(*row->text.lines), sizeof(float));
+    if (!row->text.lineBuffer || !row->text.lines) {
+        slide->rowCount--;
+        return 0;
+    }
+    memcpy(row->text.lineBuffer, text, textLength + 1);
+    row->text.lineCount = lineCount;
 
-    char *c = text;
-    while (c && *c) {
-        if (*c == '\n') row->size.pixels.y += 6;
-        c++;
+    int lineStart = 0;
+    int line = 0;
+    for (int i = 0; i <= textLength; i++) {
+        if (text[i] == '\n' || (!text[i] && i > lineStart)) {
+            row->text.lineBuffer[i] = 0;
+            row->text.lines[line].offset = lineStart;
+            row->text.lines[line].length = i - lineStart;
+            line++;
+            lineStart = i + 1;
+        }
     }
 
     if (pctHeight) {
         row->size.percent = pctHeight;
     }
 
-    row->text.font = font;
-    row->text.text = text;
+    row->text.fontSize = fontSize;
+    RowTextWrapInit(&row->text, lineCount + spaces);
+    FontCacheText(text);
+    RowTextMeasure(row);
     return row;
 }
 
-Row *PushRowImage(Slide *slide, Texture texture, float pctHeight)
+// Push a text row whose lines are already split and measured, e.g. from a
+// mapped deck pack, measured at a fontScale of 1. The buffers are used
+// as-is and not owned by the row, and the text is not read until the row is
+// laid out: wrapCapacity is its line count plus its spaces. Its glyphs must
+// already be cached, see FontCacheText.
+Row *PushRowTextMeasured(Slide *slide, float fontSize, char *lineBuffer, RowTextLine *lines, int lineCount, int wrapCapacity, Vector2 pixels, float pctHeight)
 {
-    Row *row = PushRow(slide, Row_Image);
+    Row *row = PushRow(slide, Row_Text);
     if (!row) {
         return 0;
     }
 
-    row->size.pixels = (Vector2){ (float)texture.width, (float)texture.height };
+    row->size.pixels = pixels;
     if (pctHeight) {
         row->size.percent = pctHeight;
     }
 
-    row->image.texture = texture;
+    row->text.fontSize = fontSize;
+    row->text.lineBuffer = lineBuffer;
+    row->text.lines = lines;
+    row->text.lineCount = lineCount;
+    row->text.measureSize = fontSize;
+    RowTextWrapInit(&row->text, wrapCapacity);
     return row;
 }
 
-Slide *MakeSlide(void)
+// The image is decoded in the background; until it is ready the row lays out
+// with a zero native size and draws a placeholder
+Row *PushRowImage(Slide *slide, const char *path, float pctHeight)
 {
-    if (slideCount >= MAX_SLIDES) {
+    int image = ImageRegister(path);
+    if (image < 0) {
         return 0;
     }
 
-    Slide *slide = &slides[slideCount++];
-    return slide;
+    Row *row = PushRow(slide, Row_Image);
+    if (!row) {
+        return 0;
+    }
+
+    if (pctHeight) {
+        row->size.percent = pctHeight;
+    }
+
+    row->image.image = image;
+    return row;
 }
 
-Slide *MakeTextSlide(const char *title, const char *subtitle)
+Slide *MakeSlide(void)
 {
-    Slide *slide = MakeSlide();
+    Slide *slide = ArenaPush(&slideStore.slides, sizeof(Slide), sizeof(void *));
     if (!slide) {
         return 0;
     }
 
-    PushRowEmpty(slide, 0.35f);
-    PushRowText(slide, font36, title, 0.1f);
-    if (subtitle) {
-        PushRowText(slide, font24, subtitle, 0.1f);
-    }
-    PushRowEmpty(slide, 0.45f);
+    memset(slide, 0, sizeof(*slide));
+    slide->fade = -1.0f;
+    slides = (Slide *)slideStore.slides.base;
+    slideCount++;
+    slideStore.summariesStale = true;
     return slide;
 }
 
-Slide *MakeImageSlide(const char *title, Texture texture, const char *subtitle)
+// Free every slide and its rows. Registered images stay loaded.
+void SlidesClear(void)
 {
-    Slide *slide = MakeSlide();
-    if (!slide) {
-        return 0;
-    }
+    ArenaRelease(&slideStore.slides);
+    ArenaRelease(&slideStore.rows);
+    ArenaRelease(&slideStore.data);
+    ArenaRelease(&slideStore.summaries);
+    slideStore.summariesStale = false;
+    slides = 0;
+    slideCount = 0;
+    slide = 0;
+    textureCache.slide = -1;
+}
 
-    PushRowText(slide, font36, title, 0.1f);
-    PushRowImage(slide, texture, 0.7f);
-    if (subtitle) {
-        PushRowText(slide, font24, subtitle, 0.2f);
+// One summary byte per slide, so the footer reads a byte per box instead of
+// walking rows. Packed again only after slides were added or changed
+// (reloads reorder slides, so they count as changes). Null without slides
+// or memory.
+const unsigned char *SlideSummaries(void)
+{
+    if (slideStore.summariesStale) {
+        slideStore.summaries.used = 0;
+        unsigned char *summaries = ArenaPush(&slideStore.summaries, slideCount, 1);
+        if (!summaries) {
+            return 0;
+        }
+        for (int i = 0; i < slideCount; i++) {
+            summaries[i] = slides[i].summary;
+        }
+        slideStore.summariesStale = false;
     }
-    return slide;
+    return slideStore.summaries.base;
 }
 
-void RowDraw(Row *row, float y)
+// Copy every slide's rows and text into fresh arenas, dropping the rows of
+// slides that were replaced by DeckReload. Rows pointing outside the store
+// (e.g. into a mapped pack) are left as they are.
+bool SlidesCompact(void)
 {
-    Vector2 pos = { 0, y };
-    switch (row->type) {
-        case Row_Text: {
-            pos.y += floorf((row->size.actual.y - row->size.pixels.y) / 2.0f);
-
-            char buf[2048] = { 0 };
-            const char *c = row->text.text;
-            const char *lineStart = c;
-            while (c && *c) {
-                if (*c == '\n') {
-                    const char *text = TextFormat("%.*s", c - lineStart, lineStart);
-                    Vector2 size = MeasureTextEx(row->text.font, text, row->text.font.baseSize, 1.0f);
-                    pos.x = floorf(GetRenderWidth() / 2.0f - size.x / 2.0f);
-                    DrawTextEx(row->text.font, text, pos, (float)row->text.font.baseSize, 1.0f, WHITE);
-                    pos.y += row->text.font.baseSize;
-                    lineStart = c + 1;
+    SlideStore store = { 0 };
+    const Arena *data = &slideStore.data;
+    for (int i = 0; i < slideCount; i++) {
+        const Slide *slide = &slides[i];
+        if (!slide->rowCount) {
+            continue;
+        }
+        Row *rows = ArenaPush(&store.rows, slide->rowCount * sizeof(Row), sizeof(void *));
+        if (!rows) {
+            goto fail;
+        }
+        memcpy(rows, slide->rows, slide->rowCount * sizeof(Row));
+        for (int r = 0; r < slide->rowCount; r++) {
+            RowText *text = &rows[r].text;
+            if (rows[r].type != Row_Text) {
+                continue;
+            }
+            const size_t size = RowTextBufferSize(text);
+            const bool wrapped = text->wrapped == text->wrapBuffer;
+            if ((unsigned char *)text->lineBuffer >= data->base && (unsigned char *)text->lineBuffer < data->base + data->used) {
+                char *lineBuffer = ArenaPush(&store.data, size, 1);
+                RowTextLine *lines = ArenaPush(&store.data, text->lineCount * sizeof(*lines), sizeof(float));
+                if (!lineBuffer || !lines) {
+                    goto fail;
                 }
-                c++;
+                memcpy(lineBuffer, text->lineBuffer, size);
+                memcpy(lines, text->lines, text->lineCount * sizeof(*lines));
+                text->lineBuffer = lineBuffer;
+                text->lines = lines;
             }
 
-            if (c > lineStart) {
-                const char *text = TextFormat("%.*s", c - lineStart, lineStart);
-                Vector2 size = MeasureTextEx(row->text.font, text, row->text.font.baseSize, 1.0f);
-                pos.x = floorf(GetRenderWidth() / 2.0f - size.x / 2.0f);
-                DrawTextEx(row->text.font, text, pos, (float)row->text.font.baseSize, 1.0f, WHITE);
-                pos.y += row->text.font.baseSize;
-                lineStart = c + 1;
+            // Pack rows keep their lines in the mapping but wrap in the arena
+            if (!text->wrapBuffer) {
+                text->wrapped = text->lines;
+                continue;
+            }
+            RowTextLine *wrapBuffer = ArenaPush(&store.data, (text->wrapCapacity + 1) * sizeof(*wrapBuffer), sizeof(float));
+            Vector2 *advances = ArenaPush(&store.data, size * sizeof(Vector2), sizeof(float));
+            if (!wrapBuffer || !advances) {
+                goto fail;
+            }
+            memcpy(wrapBuffer, text->wrapBuffer, (text->wrapCapacity + 1) * sizeof(*wrapBuffer));
+            memcpy(advances, text->advances, size * sizeof(Vector2));
+            text->wrapBuffer = wrapBuffer;
+            text->advances = advances;
+            text->wrapped = wrapped ? wrapBuffer : text->lines;
+        }
+    }
+
+    // Rows were copied in slide order, so the new arena is walked in step
+    Row *rows = (Row *)store.rows.base;
+    for (int i = 0; i < slideCount; i++) {
+        if (slides[i].rowCount) {
+            slides[i].rows = rows;
+            rows += slides[i].rowCount;
+        }
+    }
+    ArenaRelease(&slideStore.rows);
+    ArenaRelease(&slideStore.data);
+    slideStore.rows = store.rows;
+    slideStore.data = store.data;
+    return true;
+
+fail:
+    ArenaRelease(&store.rows);
+    ArenaRelease(&store.data);
+    return false;
+}
+
+void RowLayout(Row *row, Rectangle bounds)
+{
+    row->bounds = bounds;
+    switch (row->type) {
+        case Row_Text: {
+            RowText *text = &row->text;
+            if ((int)bounds.width != text->centerWidth) {
+                RowTextCenter(row, (int)bounds.width);
             }
 
+            row->content.x = bounds.x;
+            row->content.y = bounds.y + floorf((row->size.actual.y - row->size.pixels.y) / 2.0f);
+            row->content.width = row->size.actual.x;
+            row->content.height = row->size.pixels.y;
             break;
         }
         case Row_Image: {
-            float aspect = row->image.texture.width / (float)row->image.texture.height;
+            const ImageAsset *image = &images[row->image.image];
+            float aspect = image->width ? image->width / (float)image->height : 4.0f / 3.0f;
             Vector2 destSize = { 0 };
-            if (row->size.actual.x >= row->size.pixels.x && row->size.actual.y >= row->size.pixels.y) {
+            if (!image->width) {
+                // Placeholder until the image is decoded
+                destSize.y = floorf(row->size.actual.y);
+                destSize.x = floorf(destSize.y * aspect);
+                if (destSize.x > row->size.actual.x) {
+                    destSize.x = floorf(row->size.actual.x);
+                    destSize.y = floorf(destSize.x / aspect);
+                }
+            } else if (row->size.actual.x >= row->size.pixels.x && row->size.actual.y >= row->size.pixels.y) {
                 destSize.x = row->size.pixels.x;
                 destSize.y = row->size.pixels.y;
             } else {
@@ -204,26 +1022,119 @@ void RowDraw(Row *row, float y)
                     destSize.y = floorf(row->size.actual.y);
                 }
             }
-            pos.x = floorf(GetRenderWidth() / 2.0f - destSize.x / 2.0f);
+            row->content.x = bounds.x + floorf(bounds.width / 2.0f - destSize.x / 2.0f);
+            row->content.y = bounds.y;
             if (destSize.y < row->size.actual.y) {
-                pos.y += floorf((row->size.actual.y - destSize.y) / 2.0f);
+                row->content.y += floorf((row->size.actual.y - destSize.y) / 2.0f);
             }
-            Rectangle src = { 0, 0, (float)row->image.texture.width, (float)row->image.texture.height };
-            Rectangle dst = { pos.x, pos.y, destSize.x, destSize.y };
-            DrawTexturePro(row->image.texture, src, dst, (Vector2){ 0, 0 }, 0, WHITE);
+            row->content.width = destSize.x;
+            row->content.height = destSize.y;
+            break;
+        }
+        default: {
+            row->content = bounds;
             break;
         }
     }
 }
 
-void SlideDraw(Slide *slide, float *y, float height)
+void RowDraw(Row *row)
 {
+    switch (row->type) {
+        case Row_Text: {
+            if (TextMeshDraw(row)) {
+                break;
+            }
+            const RowText *text = &row->text;
+            const float fontSize = text->measureSize;
+            Vector2 pos = { 0, row->content.y };
+            BeginShaderMode(fontShader);
+            for (int i = 0; i < text->wrappedCount; i++) {
+                const RowTextLine *line = &text->wrapped[i];
+                pos.x = row->content.x + line->x;
+                DrawTextLine(text->lineBuffer + line->offset, line->length, pos, fontSize, 1.0f, WHITE);
+                pos.y += fontSize;
+            }
+            EndShaderMode();
+            break;
+        }
+        case Row_Image: {
+            const ImageAsset *image = &images[row->image.image];
+            if (image->texture.id) {
+                Rectangle src = { 0, 0, (float)image->texture.width, (float)image->texture.height };
+                DrawTexturePro(image->texture, src, row->content, (Vector2){ 0, 0 }, 0, WHITE);
+            } else {
+                DrawRectangleRec(row->content, ColorBrightness(DARKGRAY, -0.6f));
+                DrawRectangleLinesEx(row->content, 1.0f, DARKGRAY);
+            }
+            break;
+        }
+        default: break;
+    }
+}
+
+// RowDraw into a CPU image, for the headless export. Image rows draw the
+// decoded pixels instead of the texture.
+void RowDrawImage(Image *dst, const Row *row)
+{
+    switch (row->type) {
+        case Row_Text: {
+            const RowText *text = &row->text;
+            const float fontSize = text->measureSize;
+            Vector2 pos = { 0, row->content.y };
+            for (int i = 0; i < text->wrappedCount; i++) {
+                const RowTextLine *line = &text->wrapped[i];
+                pos.x = row->content.x + line->x;
+                ImageDrawTextLine(dst, text->lineBuffer + line->offset, line->length, pos, fontSize, 1.0f, WHITE);
+                pos.y += fontSize;
+            }
+            break;
+        }
+        case Row_Image: {
+            const ImageAsset *image = &images[row->image.image];
+            const Image pixels = image->image.data ? image->image : image->packed;
+            if (pixels.data) {
+                Rectangle src = { 0, 0, (float)pixels.width, (float)pixels.height };
+                ImageDraw(dst, pixels, src, row->content, WHITE);
+            } else {
+                ImageDrawRectangleRec(dst, row->content, ColorBrightness(DARKGRAY, -0.6f));
+                ImageDrawRectangleLines(dst, row->content, 1, DARKGRAY);
+            }
+            break;
+        }
+        default: break;
+    }
+}
+
+// Resolve row rects for the given area. Only does work when the area or the
+// slide's content changed since the last call.
+void SlideLayout(Slide *slide, Rectangle area)
+{
+    if (slide->layoutGeneration == slide->generation &&
+        slide->layoutImageGeneration == imageGeneration &&
+        slide->layoutArea.x == area.x && slide->layoutArea.y == area.y &&
+        slide->layoutArea.width == area.width && slide->layoutArea.height == area.height)
+    {
+        return;
+    }
+    TRACE_BEGIN("SlideLayout");
+
     // Count dynamic rows (to divide dynamic height)
-    float leftoverHeight = height;
+    float leftoverHeight = area.height;
     float leftoverPct = 1.0f;
     int dynamicRows = 0;
     for (int i = 0; i < slide->rowCount; i++) {
         Row *row = &slide->rows[i];
+        if (row->type == Row_Image) {
+            const ImageAsset *image = &images[row->image.image];
+            row->size.pixels = (Vector2){ (float)image->width, (float)image->height };
+        } else if (row->type == Row_Text && row->text.fontSize) {
+            const RowText *text = &row->text;
+            if (text->measureSize != text->fontSize * fontScale) {
+                RowTextMeasure(row);
+            }
+            RowTextWrap(row, (int)area.width);
+        }
         if (row->size.percent) {
             dynamicRows++;
             if (row->size.percent > 0) {
@@ -236,158 +1147,158 @@ void SlideDraw(Slide *slide, float *y, float height)
 
     // Update dynamic rows to have appropriate height
     float dynamicHeight = leftoverHeight / dynamicRows;
+    float y = area.y;
     for (int i = 0; i < slide->rowCount; i++) {
         Row *row = &slide->rows[i];
         row->size.actual = row->size.pixels;
-        if (row->size.actual.x > (float)GetRenderWidth()) {
-            row->size.actual.x = (float)GetRenderWidth();
-        }
         if (row->size.percent > 0) {
             row->size.actual.y = floorf(leftoverHeight * row->size.percent);
         } else if (row->size.percent < 0) {
             row->size.actual.y = floorf(dynamicHeight);
         }
+        if (row->type == Row_Text && !row->text.fontSize) {
+            RowTextFit(row, (int)area.width, (int)row->size.actual.y);
+            row->size.actual.x = row->size.pixels.x;
+        }
+        if (row->size.actual.x > area.width) {
+            row->size.actual.x = area.width;
+        }
+
+        RowLayout(row, (Rectangle){ area.x, y, area.width, row->size.actual.y });
+        y += row->size.actual.y;
     }
 
+    slide->layoutGeneration = slide->generation;
+    slide->layoutImageGeneration = imageGeneration;
+    slide->layoutArea = area;
+    TRACE_END("SlideLayout");
+}
+
+void SlideDraw(const Slide *slide)
+{
     for (int i = 0; i < slide->rowCount; i++) {
-        Row *row = &slide->rows[i];
-        RowDraw(row, *y);
-        *y += row->size.actual.y;
+        RowDraw(&slide->rows[i]);
     }
 }
 
-int main(int argc, char *argv[])
+void SlideDrawImage(Image *dst, const Slide *slide)
 {
-    InitWindow(800, 600, "Slideshow");
-    SetWindowState(FLAG_WINDOW_RESIZABLE);
-    SetWindowState(FLAG_VSYNC_HINT);
-
-    font16 = LoadFontEx("KarminaBold.otf", 16, 0, 0);
-    font24 = LoadFontEx("KarminaBold.otf", 24, 0, 0);
-    font36 = LoadFontEx("KarminaBold.otf", 36, 0, 0);
-
-    Texture babyTex = LoadTexture("baby.png");
-    Texture schoolTex = LoadTexture("school.png");
-    Texture graduateTex = LoadTexture("graduate.png");
-    Texture animTex = LoadTexture("anim.png");
-
-    MakeTextSlide("Owl's Story", "Master of the WingDings (TM)");
-    MakeImageSlide("Jan 1, 2003", babyTex, "Owl's Birthday");
-    MakeImageSlide("Aug 28, 2008", schoolTex, "Owl's first day of school");
-    MakeImageSlide("May 15, 2025", graduateTex, "Owl graduates college");
-    MakeImageSlide("Animation Editor", animTex,
-        "Allows you to split a spritesheet into frames,\n"
-        "edit frame properties, and create and preview animations.\n"
-        "\n"
-        "This has the added benefit of being able to play the animations\n"
-        "back at full speed, or frame-by-frame, allowing the artist to\n"
-        "quickly sanity check their work without leaving the editor.\n"
-    );
-    MakeTextSlide("The End.", 0);
-
-    bool hoveringBox = false;
-
-    const float barSize = 16;
-    const float iconMargin = 4;
-
-    while (!WindowShouldClose()) {
-        const double now = GetTime();
-        const Vector2 mouse = GetMousePosition();
+    for (int i = 0; i < slide->rowCount; i++) {
+        RowDrawImage(dst, &slide->rows[i]);
+    }
+}
 
-        const int boxBarY = GetRenderHeight() - barSize;
+// Largest size an image row can be drawn at on the current monitor: a row is
+// never wider than the render width, and a percent row never taller than that
+// percentage of the render height.
+Vector2 ImageRowMaxSize(const Row *row)
+{
+    const int monitor = GetCurrentMonitor();
+    const Vector2 dpi = GetWindowScaleDPI();
+    Vector2 size = {
+        ceilf(GetMonitorWidth(monitor) * dpi.x),
+        ceilf(GetMonitorHeight(monitor) * dpi.y)
+    };
+    if (size.x < GetRenderWidth()) size.x = (float)GetRenderWidth();
+    if (size.y < GetRenderHeight()) size.y = (float)GetRenderHeight();
+    if (row->size.percent > 0 && row->size.percent < 1) {
+        size.y = ceilf(size.y * row->size.percent);
+    }
+    return size;
+}
 
-        if (IsKeyPressed(KEY_RIGHT) || IsKeyPressedRepeat(KEY_RIGHT) ||
-            (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && mouse.y > barSize && mouse.y < boxBarY) ||
-            GetMouseWheelMove() < 0)
-        {
-            if (slide < slideCount - 1) {
-                slide++;
-            }
+void TextureCacheStamp(int slideIndex, bool current)
+{
+    Slide *slide = &slides[slideIndex];
+    for (int i = 0; i < slide->rowCount; i++) {
+        Row *row = &slide->rows[i];
+        if (row->type != Row_Image) {
+            continue;
         }
-        if (IsKeyPressed(KEY_LEFT) || IsKeyPressedRepeat(KEY_LEFT) ||
-            (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) && mouse.y > barSize && mouse.y < boxBarY) ||
-            GetMouseWheelMove() > 0)
-        {
-            if (slide) {
-                slide--;
+        ImageAsset *image = &images[row->image.image];
+        image->lastUsed = textureCache.clock;
+        Vector2 maxSize = ImageRowMaxSize(row);
+        if (LoaderQueue(row->image.image, (int)maxSize.x, (int)maxSize.y, current, false)) {
+            if (current) {
+                textureCache.misses++;
+            } else {
+                textureCache.prefetches++;
             }
+        } else if (current && image->state == Image_Ready) {
+            textureCache.hits++;
         }
-        if (IsKeyPressed(KEY_HOME)) {
-            slide = 0;
-        }
-        if (IsKeyPressed(KEY_END)) {
-            slide = slideCount - 1;
-        }
-
-        ClearBackground(BLACK);
-        BeginDrawing();
-
-        // Header
-        DrawRectangle(0, 0, GetRenderWidth(), barSize, ColorBrightness(DARKGRAY, -0.5f));
-        DrawTextEx(font16, TextFormat("%d of %d", slide + 1, slideCount), (Vector2){ 4, 0 }, (float)font16.baseSize, 1.0f, WHITE);
-
-        // Slide
-        float slideY = font16.baseSize + 8.0f;
-        SlideDraw(&slides[slide], &slideY, boxBarY - slideY);
-
-        // Footer
-        DrawRectangle(0, (int)GetRenderHeight() - barSize, GetRenderWidth(), barSize, ColorBrightness(DARKGRAY, -0.5f));
+    }
+}
 
-        hoveringBox = false;
-        Vector2 boxPos = { 0, (float)GetRenderHeight() - barSize };
+// Request the images around the current slide and evict textures outside
+// that window until the cache is back under budget. Main thread only.
+void TextureCacheUpdate(int current)
+{
+    if (current != textureCache.slide) {
+        textureCache.slide = current;
+        textureCache.clock++;
 
-        for (int i = 0; i < slideCount; i++) {
-            Rectangle rec = { boxPos.x, boxPos.y, barSize, barSize };
-            Color color = i == slide ? BLUE : BLANK;
-            if (CheckCollisionPointRec(mouse, rec)) {
-                hoveringBox = true;
-                if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-                    slide = i;
-                } else {
-                    color = SKYBLUE;
-                }
+        // Nearest slides first, so they are decoded first
+        TextureCacheStamp(current, true);
+        for (int distance = 1; distance <= textureCache.prefetchSlides; distance++) {
+            if (current + distance < slideCount) {
+                TextureCacheStamp(current + distance, false);
             }
-            DrawRectangleRec(rec, color);
-
-            RowType rowType = 0;
-            for (int r = 0; r < slides[r].rowCount; r++) {
-                Row *row = &slides[i].rows[r];
-                if (row->type > rowType) {
-                    rowType = row->type;
-                }
+            if (current - distance >= 0) {
+                TextureCacheStamp(current - distance, false);
             }
+        }
+    } else if (textureCache.imageGeneration == imageGeneration) {
+        return;
+    }
+    textureCache.imageGeneration = imageGeneration;
 
-            switch (rowType) {
-                case Row_Text: {
-                    rec.x += iconMargin;
-                    rec.y += iconMargin;
-                    rec.width -= iconMargin * 2;
-                    rec.height -= iconMargin * 2;
-                    DrawRectangleRec(rec, LIGHTGRAY);
-                    break;
-                }
-                case Row_Image: {
-                    Vector2 v1 = { rec.x + iconMargin            , rec.y + rec.height - iconMargin };  // bottom left
-                    Vector2 v2 = { rec.x + rec.width - iconMargin, rec.y + rec.height - iconMargin };  // bottom right
-                    Vector2 v3 = { rec.x + rec.width / 2         , rec.y + iconMargin              };  // top middle
-                    DrawTriangle(v1, v2, v3, PURPLE);
-                    break;
-                }
+    while (textureCache.used > textureCache.budget) {
+        int lru = -1;
+        for (int i = 0; i < imageCount; i++) {
+            const ImageAsset *image = &images[i];
+            if (image->state == Image_Ready && image->lastUsed != textureCache.clock &&
+                (lru < 0 || image->lastUsed < images[lru].lastUsed))
+            {
+                lru = i;
             }
-
-            boxPos.x += barSize;
+        }
+        if (lru < 0) {
+            break;
         }
 
-        EndDrawing();
+        ImageAsset *image = &images[lru];
+        UnloadTexture(image->texture);
+        image->texture = (Texture){ 0 };
+        textureCache.used -= image->bytes;
+        image->bytes = 0;
+        PlatformMutexLock(loader.mutex);
+        image->state = Image_Unloaded;
+        PlatformMutexUnlock(loader.mutex);
+        textureCache.evictions++;
     }
+}
 
-    UnloadFont(font16);
-    UnloadFont(font24);
-    UnloadFont(font36);
-    UnloadTexture(babyTex);
-    UnloadTexture(schoolTex);
-    UnloadTexture(graduateTex);
-    UnloadTexture(animTex);
-    CloseWindow();
-    return 0;
-}
\ No newline at end of file
+// Reload images on the given (laid out) slide whose downscaled texture is now
+// drawn larger than it was decoded, e.g. after moving to a bigger monitor
+void TextureCacheCheckResolution(const Slide *slide)
+{
+    for (int i = 0; i < slide->rowCount; i++) {
+        const Row *row = &slide->rows[i];
+        if (row->type != Row_Image) {
+            continue;
+        }
+        const ImageAsset *image = &images[row->image.image];
+        if (image->state != Image_Ready || image->texture.width >= image->width) {
+            continue;
+        }
+        // Only when drawn beyond the size last requested, so a reload that
+        // could not do better (e.g. a pack whose source image is gone) is
+        // not retried every frame
+        if ((row->content.width > image->texture.width || row->content.height > image->texture.height) &&
+            (row->content.width > image->maxWidth || row->content.height > image->maxHeight))
+        {
+            LoaderQueue(row->image.image, (int)ceilf(row->content.width), (int)ceilf(row->content.height), true, true);
+        }
+    }
+}
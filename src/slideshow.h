@@ -0,0 +1,454 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "raylib/raylib.h"
+#include "platform.h"
+
+#define MAX_LOADER_THREADS 16
+
+#define ARENA_RESERVE (8ull << 30)   // address space reserved per arena
+#define ARENA_COMMIT (1ull << 20)    // granularity arenas commit memory in
+
+#define UPLOAD_BUDGET_SECONDS 0.004  // max main thread time per frame spent on texture uploads
+#define DEFAULT_TEXTURE_BUDGET_MB 256
+#define DEFAULT_PREFETCH_SLIDES 2
+#define IDLE_POLL_SECONDS (1.0 / 60.0)
+
+#define FONT_PATH "KarminaBold.otf"
+#define FONT_SDF_SIZE 48            // size the distance field glyphs are generated at
+#define UI_FONT_SIZE 16             // header, footer and profiler overlay
+#define TEXT_FIT_MIN_SIZE 8         // smallest size a fit text row shrinks to
+
+typedef enum {
+    Image_Unloaded, // not requested yet, or evicted from the texture cache
+    Image_Queued,   // waiting for (or being decoded by) a loader thread
+    Image_Decoded,  // pixels in memory, waiting for the main thread to upload them
+    Image_Ready,    // texture uploaded
+    Image_Failed
+} ImageState;
+
+typedef struct {
+    char *path;
+    ImageState state;   // guarded by loader.mutex
+    Image image;        // decoded pixels, owned by the loader until uploaded
+    Image packed;       // pre-decoded pixels in a mapped deck pack, not owned
+    Texture texture;
+    int width;          // native size, 0 until first decoded, kept across evictions
+    int height;
+    int maxWidth;       // largest size the image can be drawn at, decodes are downscaled to fit
+    int maxHeight;      // guarded by loader.mutex
+    int decodedWidth;   // native size reported by the loader thread, guarded by loader.mutex
+    int decodedHeight;
+    int bytes;          // texture memory while resident
+    bool stale;         // file changed while queued or decoded, reload after upload
+    unsigned int lastUsed;  // TextureCache.clock when last in the prefetch window
+} ImageAsset;
+
+typedef struct {
+    PlatformMutex *mutex;
+    PlatformCond *wake;
+    PlatformThread *threads[MAX_LOADER_THREADS];
+    int threadCount;
+    bool quit;
+    int pending;                // images queued, decoding or waiting for upload
+
+    // An image waits in each ring at most once, so the rings grow with the
+    // image table and never fill up
+    int capacity;               // of each ring
+    int *queue;                 // ring of image indices waiting for a loader thread
+    int queueHead;
+    int queueCount;
+
+    int *decoded;               // ring of image indices waiting for upload
+    int decodedHead;
+    int decodedCount;
+} ImageLoader;
+
+// Resident textures, evicted least recently used first once over budget.
+// Images on slides within prefetchSlides of the current one are never evicted.
+typedef struct {
+    long long budget;       // bytes
+    long long used;         // bytes
+    int prefetchSlides;
+    unsigned int clock;
+    int slide;              // slide the window was last updated for, -1 to force
+    unsigned int imageGeneration;
+
+    unsigned int hits;      // image already resident when its slide was shown
+    unsigned int misses;    // image had to be loaded after its slide was shown
+    unsigned int prefetches;
+    unsigned int evictions;
+} TextureCache;
+
+typedef enum {
+    Row_Empty,
+    Row_Text,
+    Row_Image
+} RowType;
+
+typedef struct {
+    int offset;     // byte offset of the line in RowText.lineBuffer
+    int length;     // line length in bytes
+    float width;    // measured width at RowText.measureSize
+    float x;        // centered x for RowText.centerWidth
+} RowTextLine;
+
+typedef struct {
+    float fontSize;         // as given in the deck, drawn at fontSize * fontScale; 0 to fit the row, see RowTextFit
+    char *lineBuffer;       // copy of text with '\n' replaced by '\0', one string per line
+    RowTextLine *lines;     // one per line of the text
+    int lineCount;
+    RowTextLine *wrapped;   // lines as drawn: lines itself while they all fit, else wrapBuffer
+    int wrappedCount;
+    RowTextLine *wrapBuffer;     // room for a break at every space, allocated on first layout
+    int wrapCapacity;       // lines plus spaces, counted when the row is pushed
+    Vector2 *advances;      // prefix sums of glyph advances by byte offset, see RowTextAdvances
+    bool advancesReady;
+    float measureSize;      // font size the line widths were measured and are drawn at
+    int wrapWidth;          // width the lines were wrapped for, -1 to wrap again
+    int fitWidth;           // row size a fit row's font size was chosen for, -1 for none yet
+    int fitHeight;
+    int mesh;               // slot in textMeshes + 1, 0 for none, see TextMeshDraw
+    bool meshStale;         // lines moved since the mesh was built
+    int centerWidth;        // render width the line x positions were centered in
+} RowText;
+
+typedef struct {
+    int image;  // index into images
+} RowImage;
+
+typedef struct {
+    float percent;  // 0 = fixed pixels, >0 = percent, <0 = dynamic fill
+    Vector2 pixels;
+    Vector2 actual;
+} RowSize;
+
+typedef struct {
+    RowType type;
+    RowSize size;
+    Rectangle bounds;   // resolved by SlideLayout, the full row area
+    Rectangle content;  // resolved by SlideLayout, text block or image destination
+    union {
+        RowText text;
+        RowImage image;
+    };
+} Row;
+
+// Slide.summary flags: what the footer icon shows, images taking priority
+#define SLIDE_SUMMARY_TEXT  0x01
+#define SLIDE_SUMMARY_IMAGE 0x02
+
+typedef struct {
+    int rowCount;
+    Row *rows;                      // contiguous, in SlideStore.rows
+    unsigned char summary;          // SLIDE_SUMMARY_* of its rows, kept up to date by PushRow
+    unsigned int generation;        // bumped whenever the slide's content changes
+    unsigned int layoutGeneration;  // generation the cached row rects were resolved for
+    unsigned int layoutImageGeneration;
+    Rectangle layoutArea;           // area the cached row rects were resolved for
+    unsigned long long sourceHash;  // hash of the deck lines the slide was parsed from
+    float duration;                 // video export: seconds on screen, 0 for the default
+    float fade;                     // video export: seconds of cross-fade from the previous slide, <0 for the default
+    int thumbnail;                  // footer thumbnail slot + 1, 0 for none, see thumbnails.c
+} Slide;
+
+// Bump allocator over one reserved address range that is committed as it
+// grows: contiguous, pointers never move, and freed all at once
+typedef struct {
+    unsigned char *base;
+    size_t reserved;
+    size_t committed;
+    size_t used;
+} Arena;
+
+// Everything a loaded deck's slides own, freed in one shot by SlidesClear
+typedef struct {
+    Arena slides;   // the Slide array
+    Arena rows;     // rows, each slide's rows contiguous
+    Arena data;     // text line buffers and line tables
+    Arena summaries;        // every slide's summary byte, packed, see SlideSummaries
+    bool summariesStale;    // slides were added or changed since they were packed
+} SlideStore;
+
+void *ArenaPush(Arena *arena, size_t size, size_t align);
+void ArenaRelease(Arena *arena);
+
+extern ImageAsset *images;     // grows in place, entries never move
+extern int imageCount;
+extern unsigned int imageGeneration;   // bumped whenever an image finishes loading
+extern ImageLoader loader;
+extern TextureCache textureCache;
+
+extern SlideStore slideStore;
+extern Slide *slides;           // slideStore.slides as an array
+extern int slideCount;
+extern int slide;
+
+Slide *MakeSlide(void);
+void SlidesClear(void);
+bool SlidesCompact(void);
+const unsigned char *SlideSummaries(void);
+Row *PushRowEmpty(Slide *slide, float pctHeight);
+Row *PushRowText(Slide *slide, float fontSize, const char *text, float pctHeight);
+Row *PushRowTextMeasured(Slide *slide, float fontSize, char *lineBuffer, RowTextLine *lines, int lineCount, int wrapCapacity, Vector2 pixels, float pctHeight);
+bool SlidesWrapAlloc(void);
+Row *PushRowImage(Slide *slide, const char *path, float pctHeight);
+void LoaderInit(void);
+void LoaderShutdown(void);
+void LoaderUpload(double budget);
+int LoaderPending(void);
+int ImageRegister(const char *path);
+void ImageAttachPacked(int index, Image pixels, int width, int height);
+void ImagesDetachPacked(void);
+void ImageReload(int index);
+void ImagesUnload(void);
+void ImageFit(Image *image, int maxWidth, int maxHeight);
+void SlideLayout(Slide *slide, Rectangle area);
+void SlideDraw(const Slide *slide);
+void SlideDrawImage(Image *dst, const Slide *slide);
+void TextureCacheUpdate(int current);
+void TextureCacheCheckResolution(const Slide *slide);
+
+// deck.c
+typedef struct {
+    char *path;
+    char *text;     // file contents, parsed in place
+    void *map;      // mapped deck pack, rows and images point into it
+    size_t mapSize;
+    unsigned int generation;    // bumped whenever the deck is reloaded
+    PlatformWatcher *watcher;   // deck file and images, see DeckWatch
+    int watchedImages;          // images already added to the watcher
+    PlatformThread *watchThread;    // wakes the main loop on changes, if any
+    PlatformMutex *watchMutex;
+    PlatformCond *watchTaken;   // DeckWatchUpdate took the changes
+    bool watchWoken;            // main loop woken, changes not taken yet
+    bool watchQuit;
+} Deck;
+
+extern Deck deck;
+
+bool DeckParse(char *text, const char *name);
+bool DeckLoad(const char *path);
+void DeckUnload(void);
+bool DeckReload(void);
+void DeckWatch(void);
+bool DeckWatchUpdate(void);
+
+// profiler.c
+#define PROFILER_HISTORY 240    // frames in the overlay graph and percentiles
+
+typedef enum {
+    Phase_Input,
+    Phase_Layout,   // SlideLayout
+    Phase_Rows,     // SlideDraw, i.e. RowDraw text and image submission
+    Phase_Footer,
+    Phase_Present,  // EndDrawing: flush, swap, vsync
+    Phase_Count
+} ProfilePhase;
+
+typedef struct {
+    float total;                // ms, the whole loop iteration
+    float phases[Phase_Count];  // ms
+} ProfileFrame;
+
+typedef struct {
+    bool visible;
+    double frameStart;
+    double phaseStart[Phase_Count];
+    float current[Phase_Count];
+    ProfileFrame history[PROFILER_HISTORY];     // ring of redrawn frames
+    int head;
+    int count;
+} Profiler;
+
+extern Profiler profiler;
+
+// Everything the rendered frame depends on. When it is unchanged from the
+// last rendered frame, idle mode skips the redraw entirely.
+typedef struct {
+    int slide;
+    int renderWidth;
+    int renderHeight;
+    int hoveredBox;  // footer box under the mouse, -1 when none or while pressed
+    int footerFirst; // first slide in the footer strip
+    unsigned int imageGeneration;
+    unsigned int deckGeneration;
+    unsigned int thumbnailGeneration;
+    int profiler;    // overlay visible, which redraws every frame
+} FrameState;
+
+// Main loop counters, logged by the player on exit and checked by the
+// bench's idle scenario. Idle frames (frames - redraws) only polled for
+// events and did not render or present anything.
+typedef struct {
+    unsigned long long frames;
+    unsigned long long redraws;
+    FrameState last;            // state of the last redrawn frame
+} FrameStats;
+
+extern FrameStats frameStats;
+
+void FrameStatsReset(void);
+bool FrameRedraw(const FrameState *frame, bool idle);
+void ProfilerFrameBegin(void);
+void ProfilerFrameEnd(void);
+void ProfilerPhaseBegin(ProfilePhase phase);
+void ProfilerPhaseEnd(ProfilePhase phase);
+void ProfilerDraw(Rectangle header);
+
+// trace.c
+#define TRACE_RING_EVENTS 65536     // per thread, the oldest are overwritten first
+#define MAX_TRACE_THREADS 64
+
+typedef struct {
+    const char *name;   // string literal
+    double time;
+    int arg;            // e.g. an image or slide index, -1 for none
+    char phase;         // 'B'egin or 'E'nd
+} TraceEvent;
+
+typedef struct {
+    TraceEvent *events;
+    volatile unsigned int head;     // events ever recorded, only written by the owning thread
+    const char *threadName;
+} TraceRing;
+
+typedef struct {
+    bool enabled;
+    const char *path;
+    double start;
+    PlatformMutex *mutex;   // guards ring registration
+    TraceRing rings[MAX_TRACE_THREADS];
+    int ringCount;
+} Trace;
+
+extern Trace trace;
+
+#define TRACE_BEGIN(name) do { if (trace.enabled) TraceRecord(name, -1, 'B'); } while (0)
+#define TRACE_BEGIN_ARG(name, arg) do { if (trace.enabled) TraceRecord(name, arg, 'B'); } while (0)
+#define TRACE_END(name) do { if (trace.enabled) TraceRecord(name, -1, 'E'); } while (0)
+
+void TraceInit(const char *path);
+void TraceThreadName(const char *name);
+void TraceRecord(const char *name, int arg, char phase);
+bool TraceDump(const char *path);
+void TraceShutdown(void);
+
+// font.c
+#define GLYPH_ATLAS_INITIAL_SIZE 512
+#define GLYPH_ATLAS_MAX_SIZE 4096
+
+typedef struct {
+    int x;
+    int y;          // top of the free space above this segment
+    int width;
+} SkylineNode;
+
+// Glyphs rasterized on demand, see font.c
+typedef struct {
+    unsigned char *data;    // font file, kept to rasterize new codepoints
+    int dataSize;
+    int capacity;           // glyphs allocated in font.glyphs and font.recs
+    int *lookup;            // open addressing, glyph index + 1 by codepoint, 0 when empty
+    int lookupSize;         // power of two
+    int fallback;           // glyph index of '?'
+
+    Image atlas;            // CPU copy of font.texture, GRAY_ALPHA; none in the headless export
+    SkylineNode *skyline;   // left to right, covering the atlas width
+    int skylineCount;
+    int skylineCapacity;
+    Rectangle dirty;        // atlas area changed since the last upload
+    bool grown;             // atlas resized since the last upload
+    bool full;              // at GLYPH_ATLAS_MAX_SIZE, warned once
+} GlyphCache;
+
+extern Font font;           // every text size is drawn from its one distance field atlas
+extern Shader fontShader;
+extern float fontScale;     // applied to every deck font size, e.g. for the export resolution
+extern GlyphCache glyphCache;
+
+bool FontLoad(const char *path, bool upload);
+void FontUnload(void);
+void FontUpload(void);
+void FontCacheText(const char *text);
+int FontGlyphIndex(int codepoint);
+float FontGlyphAdvance(int index, float scale);
+float TextLineWidth(const char *text, float fontSize, float spacing);
+void DrawTextLine(const char *text, int length, Vector2 position, float fontSize, float spacing, Color tint);
+void ImageDrawTextLine(Image *dst, const char *text, int length, Vector2 position, float fontSize, float spacing, Color tint);
+
+// textmesh.c
+#define TEXT_MESH_SLOTS 256
+
+typedef struct {
+    const Row *row;             // row the mesh was built for, 0 when free
+    Mesh mesh;
+    int atlasWidth;             // font atlas size the texture coordinates are for
+    int atlasHeight;
+    unsigned int lastUsed;      // TextMeshCache.clock when last drawn
+} TextMeshSlot;
+
+typedef struct {
+    TextMeshSlot slots[TEXT_MESH_SLOTS];
+    Material material;          // fontShader, with the font atlas bound when drawing
+    bool ready;
+    unsigned int clock;
+
+    unsigned int built;
+    unsigned int evictions;
+} TextMeshCache;
+
+extern TextMeshCache textMeshes;
+
+void TextMeshesInit(void);
+void TextMeshesUnload(void);
+bool TextMeshDraw(Row *row);
+
+// thumbnails.c
+#define THUMBNAIL_WIDTH 64
+#define THUMBNAIL_HEIGHT 36
+#define THUMBNAIL_ATLAS_SIZE 1024   // square RGBA render texture, 4 MiB
+#define THUMBNAIL_SLOTS ((THUMBNAIL_ATLAS_SIZE / THUMBNAIL_WIDTH) * (THUMBNAIL_ATLAS_SIZE / THUMBNAIL_HEIGHT))
+#define THUMBNAIL_BUDGET_SECONDS 0.002  // max main thread time per frame spent drawing thumbnails
+
+typedef struct {
+    int slide;                  // -1 when free
+    unsigned int generation;    // slide generation it was drawn for
+    unsigned int imageGeneration;
+    int missingImages;          // image rows drawn as placeholders
+    Vector2 area;               // size of the slide area it was laid out in
+    unsigned int lastUsed;      // ThumbnailCache.clock when last in the strip
+} ThumbnailSlot;
+
+typedef struct {
+    RenderTexture2D atlas;
+    ThumbnailSlot slots[THUMBNAIL_SLOTS];
+    unsigned int clock;
+    unsigned int deckGeneration;
+    unsigned int generation;    // bumped whenever a thumbnail is drawn
+    int pending;                // stale thumbnails in the strip left for later frames
+
+    unsigned int drawn;
+    unsigned int evictions;
+} ThumbnailCache;
+
+extern ThumbnailCache thumbnails;
+
+void ThumbnailsInit(void);
+void ThumbnailsUnload(void);
+void ThumbnailsUpdate(int first, int end, Rectangle area);
+bool ThumbnailSource(int slide, Rectangle *source);
+
+// export.c
+bool ExportBegin(const char *deckPath, int width, int height);
+void ExportEnd(void);
+void ExportRasterize(int slide, Image *target);
+bool ExportDeck(const char *deckPath, const char *outputDir, int width, int height, int threadCount);
+
+// video.c
+bool ExportVideo(const char *deckPath, const char *outputPath, int width, int height, int fps, float slideSeconds, float fadeSeconds);
+
+// pack.c
+bool PackCompile(const char *deckPath, const char *packPath, int maxWidth, int maxHeight);
+bool PackLoad(const char *path);
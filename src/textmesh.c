@@ -0,0 +1,196 @@
+#include "slideshow.h"
+#include "raylib/raymath.h"
+#include "raylib/rlgl.h"
+
+// Text row meshes. Each text row's glyph quads, positions relative to the
+// row's content origin and texture coordinates into the font atlas, are
+// built into one static mesh when the row's lines move, so drawing a row
+// is a single DrawMesh however many glyphs it has, with no per-glyph work
+// on the CPU from one frame to the next.
+//
+// Meshes live in a fixed pool of slots. A row names its slot, and the slot
+// the row it was built for; a row that was copied by SlidesCompact or
+// replaced by a reload no longer matches and builds a new one. Once the
+// pool is full, the least recently drawn slot is reused. Main thread only.
+
+TextMeshCache textMeshes;
+
+void TextMeshesInit(void)
+{
+    textMeshes.material = LoadMaterialDefault();
+    textMeshes.material.shader = fontShader;
+    textMeshes.ready = true;
+}
+
+void TextMeshesUnload(void)
+{
+    if (!textMeshes.ready) {
+        return;
+    }
+    for (int i = 0; i < TEXT_MESH_SLOTS; i++) {
+        if (textMeshes.slots[i].row) {
+            UnloadMesh(textMeshes.slots[i].mesh);
+        }
+    }
+    // The shader is fontShader, which FontUnload frees
+    MemFree(textMeshes.material.maps);
+    textMeshes = (TextMeshCache){ 0 };
+}
+
+// A free slot, or the least recently drawn one
+static int TextMeshAllocate(void)
+{
+    int lru = 0;
+    for (int i = 0; i < TEXT_MESH_SLOTS; i++) {
+        const TextMeshSlot *slot = &textMeshes.slots[i];
+        if (!slot->row) {
+            return i;
+        }
+        if (slot->lastUsed < textMeshes.slots[lru].lastUsed) {
+            lru = i;
+        }
+    }
+    TextMeshSlot *slot = &textMeshes.slots[lru];
+    UnloadMesh(slot->mesh);
+    slot->mesh = (Mesh){ 0 };
+    slot->row = 0;
+    textMeshes.evictions++;
+    return lru;
+}
+
+// Glyphs of the row that draw anything, two triangles each
+static int TextMeshQuads(const RowText *text)
+{
+    int quads = 0;
+    for (int l = 0; l < text->wrappedCount; l++) {
+        const RowTextLine *line = &text->wrapped[l];
+        const char *bytes = text->lineBuffer + line->offset;
+        for (int i = 0; i < line->length;) {
+            int size = 0;
+            const int codepoint = GetCodepointNext(&bytes[i], &size);
+            const int index = FontGlyphIndex(codepoint);
+            i += size;
+            if (codepoint != ' ' && codepoint != '\t' && font.recs[index].width) {
+                quads++;
+            }
+        }
+    }
+    return quads;
+}
+
+// Fill the mesh's vertices and texture coordinates with the glyphs placed
+// the way DrawTextLine places them, corners in DrawTexturePro's order
+static void TextMeshFill(const RowText *text, Mesh *mesh)
+{
+    const float scale = text->measureSize / font.baseSize;
+    const float atlasWidth = (float)font.texture.width;
+    const float atlasHeight = (float)font.texture.height;
+    float *vertex = mesh->vertices;
+    float *texcoord = mesh->texcoords;
+    for (int l = 0; l < text->wrappedCount; l++) {
+        const RowTextLine *line = &text->wrapped[l];
+        const char *bytes = text->lineBuffer + line->offset;
+        const float y = l * text->measureSize;
+        float x = line->x;
+        for (int i = 0; i < line->length;) {
+            int size = 0;
+            const int codepoint = GetCodepointNext(&bytes[i], &size);
+            const int index = FontGlyphIndex(codepoint);
+            i += size;
+            const GlyphInfo *glyph = &font.glyphs[index];
+            const Rectangle src = font.recs[index];
+            if (codepoint != ' ' && codepoint != '\t' && src.width) {
+                const float left = x + glyph->offsetX * scale;
+                const float top = y + glyph->offsetY * scale;
+                const float right = left + src.width * scale;
+                const float bottom = top + src.height * scale;
+                const float u0 = src.x / atlasWidth;
+                const float v0 = src.y / atlasHeight;
+                const float u1 = (src.x + src.width) / atlasWidth;
+                const float v1 = (src.y + src.height) / atlasHeight;
+
+                // Top left, bottom left, bottom right; top left, bottom right, top right
+                const float corners[6][4] = {
+                    { left, top, u0, v0 }, { left, bottom, u0, v1 }, { right, bottom, u1, v1 },
+                    { left, top, u0, v0 }, { right, bottom, u1, v1 }, { right, top, u1, v0 },
+                };
+                for (int c = 0; c < 6; c++) {
+                    *vertex++ = corners[c][0];
+                    *vertex++ = corners[c][1];
+                    *vertex++ = 0;
+                    *texcoord++ = corners[c][2];
+                    *texcoord++ = corners[c][3];
+                }
+            }
+            x += FontGlyphAdvance(index, scale) + 1.0f;
+        }
+    }
+}
+
+// (Re)build the row's mesh in its slot. A mesh with as many glyphs as before
+// is refilled in place; otherwise a new one is uploaded. A row without
+// glyphs has an empty mesh that was never uploaded, so nothing to refill.
+static void TextMeshBuild(Row *row, int index)
+{
+    TRACE_BEGIN("TextMeshBuild");
+    TextMeshSlot *slot = &textMeshes.slots[index];
+    const int vertexCount = TextMeshQuads(&row->text) * 6;
+    if (slot->row && vertexCount && slot->mesh.vertexCount == vertexCount) {
+        TextMeshFill(&row->text, &slot->mesh);
+        UpdateMeshBuffer(slot->mesh, 0, slot->mesh.vertices, vertexCount * 3 * sizeof(float), 0);
+        UpdateMeshBuffer(slot->mesh, 1, slot->mesh.texcoords, vertexCount * 2 * sizeof(float), 0);
+    } else {
+        if (slot->row) {
+            UnloadMesh(slot->mesh);
+        }
+        Mesh mesh = { 0 };
+        mesh.vertexCount = vertexCount;
+        mesh.triangleCount = vertexCount / 3;
+        if (vertexCount) {
+            mesh.vertices = MemAlloc(vertexCount * 3 * sizeof(float));
+            mesh.texcoords = MemAlloc(vertexCount * 2 * sizeof(float));
+            TextMeshFill(&row->text, &mesh);
+            UploadMesh(&mesh, false);
+        }
+        slot->mesh = mesh;
+    }
+    slot->row = row;
+    slot->atlasWidth = font.texture.width;
+    slot->atlasHeight = font.texture.height;
+    row->text.mesh = index + 1;
+    row->text.meshStale = false;
+    textMeshes.built++;
+    TRACE_END("TextMeshBuild");
+}
+
+// Draw a laid out text row from its mesh, building it first when the row
+// has none or its lines or the font atlas changed since. False when there
+// is no mesh pool, and the caller draws glyph by glyph instead.
+bool TextMeshDraw(Row *row)
+{
+    if (!textMeshes.ready || !font.texture.id) {
+        return false;
+    }
+    RowText *text = &row->text;
+    int index = text->mesh - 1;
+    if (index < 0 || textMeshes.slots[index].row != row) {
+        index = TextMeshAllocate();
+        TextMeshBuild(row, index);
+    } else if (text->meshStale || textMeshes.slots[index].atlasWidth != font.texture.width ||
+        textMeshes.slots[index].atlasHeight != font.texture.height)
+    {
+        TextMeshBuild(row, index);
+    }
+
+    TextMeshSlot *slot = &textMeshes.slots[index];
+    slot->lastUsed = ++textMeshes.clock;
+    if (!slot->mesh.vertexCount) {
+        return true;
+    }
+
+    // Whatever was batched so far goes first, so it stays underneath
+    rlDrawRenderBatchActive();
+    textMeshes.material.maps[MATERIAL_MAP_DIFFUSE].texture = font.texture;
+    DrawMesh(slot->mesh, textMeshes.material, MatrixTranslate(row->content.x, row->content.y, 0));
+    return true;
+}
@@ -0,0 +1,210 @@
+#include <math.h>
+#include "slideshow.h"
+
+// Footer thumbnails. Every slide in the strip is drawn once, shrunk, into a
+// slot of one shared render texture, so the whole strip is drawn from a
+// single texture in one batch. Slots are filled lazily, a few per frame
+// within THUMBNAIL_BUDGET_SECONDS, and drawn again only when their slide
+// changed, the slide area was resized, or one of the images that were
+// missing when the slide was drawn has since loaded. Once the atlas is
+// full, the least recently shown slot outside the strip is reused.
+//
+// Thumbnails only use the textures that are already resident; they never
+// make the texture cache load images for slides far from the current one.
+
+ThumbnailCache thumbnails;
+
+#define THUMBNAIL_COLUMNS (THUMBNAIL_ATLAS_SIZE / THUMBNAIL_WIDTH)
+
+static Rectangle ThumbnailSlotRect(int slot)
+{
+    return (Rectangle){
+        (float)(slot % THUMBNAIL_COLUMNS * THUMBNAIL_WIDTH),
+        (float)(slot / THUMBNAIL_COLUMNS * THUMBNAIL_HEIGHT),
+        THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT
+    };
+}
+
+void ThumbnailsInit(void)
+{
+    for (int i = 0; i < THUMBNAIL_SLOTS; i++) {
+        thumbnails.slots[i].slide = -1;
+    }
+    thumbnails.atlas = LoadRenderTexture(THUMBNAIL_ATLAS_SIZE, THUMBNAIL_ATLAS_SIZE);
+    if (!thumbnails.atlas.id) {
+        TraceLog(LOG_WARNING, "THUMBNAILS: Failed to create the %dx%d atlas", THUMBNAIL_ATLAS_SIZE, THUMBNAIL_ATLAS_SIZE);
+        return;
+    }
+    BeginTextureMode(thumbnails.atlas);
+    ClearBackground(BLACK);
+    EndTextureMode();
+}
+
+void ThumbnailsUnload(void)
+{
+    if (thumbnails.atlas.id) {
+        UnloadRenderTexture(thumbnails.atlas);
+    }
+    thumbnails.atlas = (RenderTexture2D){ 0 };
+}
+
+// Slot of the given slide's thumbnail, or -1
+static int ThumbnailFind(int index)
+{
+    const int slot = slides[index].thumbnail - 1;
+    return slot >= 0 && thumbnails.slots[slot].slide == index ? slot : -1;
+}
+
+// A reload reorders slides and drops the ones that were edited. Slides that
+// were kept still name their slot; every other slot is freed.
+static void ThumbnailsRebind(void)
+{
+    for (int i = 0; i < THUMBNAIL_SLOTS; i++) {
+        thumbnails.slots[i].slide = -1;
+    }
+    for (int i = 0; i < slideCount; i++) {
+        const int slot = slides[i].thumbnail - 1;
+        if (slot >= 0) {
+            thumbnails.slots[slot].slide = i;
+        }
+    }
+    thumbnails.deckGeneration = deck.generation;
+}
+
+// Image rows of the slide whose texture is not resident
+static int ThumbnailMissingImages(const Slide *slide)
+{
+    int missing = 0;
+    for (int i = 0; i < slide->rowCount; i++) {
+        const Row *row = &slide->rows[i];
+        if (row->type == Row_Image && !images[row->image.image].texture.id) {
+            missing++;
+        }
+    }
+    return missing;
+}
+
+static bool ThumbnailStale(int index, Rectangle area)
+{
+    const int slot = ThumbnailFind(index);
+    if (slot < 0) {
+        return true;
+    }
+    const ThumbnailSlot *thumbnail = &thumbnails.slots[slot];
+    return thumbnail->generation != slides[index].generation ||
+        thumbnail->area.x != area.width || thumbnail->area.y != area.height ||
+        (thumbnail->missingImages && thumbnail->imageGeneration != imageGeneration &&
+            ThumbnailMissingImages(&slides[index]) < thumbnail->missingImages);
+}
+
+// A free slot, or the least recently shown one outside the strip
+static int ThumbnailAllocate(void)
+{
+    int lru = -1;
+    for (int i = 0; i < THUMBNAIL_SLOTS; i++) {
+        const ThumbnailSlot *slot = &thumbnails.slots[i];
+        if (slot->slide < 0) {
+            return i;
+        }
+        if (slot->lastUsed != thumbnails.clock && (lru < 0 || slot->lastUsed < thumbnails.slots[lru].lastUsed)) {
+            lru = i;
+        }
+    }
+    if (lru >= 0) {
+        slides[thumbnails.slots[lru].slide].thumbnail = 0;
+        thumbnails.slots[lru].slide = -1;
+        thumbnails.evictions++;
+    }
+    return lru;
+}
+
+static void ThumbnailRender(int index, int slot, Rectangle area)
+{
+    TRACE_BEGIN_ARG("Thumbnail", index);
+    Slide *slide = &slides[index];
+    SlideLayout(slide, area);
+
+    // Scaled to fit the slot and centered, clipped so overflowing rows
+    // cannot spill into the neighbours
+    const Rectangle dst = ThumbnailSlotRect(slot);
+    Camera2D camera = { 0 };
+    camera.offset = (Vector2){ dst.x + dst.width / 2, dst.y + dst.height / 2 };
+    camera.target = (Vector2){ area.x + area.width / 2, area.y + area.height / 2 };
+    camera.zoom = fminf(dst.width / area.width, dst.height / area.height);
+
+    BeginTextureMode(thumbnails.atlas);
+    BeginScissorMode((int)dst.x, (int)dst.y, (int)dst.width, (int)dst.height);
+    DrawRectangleRec(dst, BLACK);
+    BeginMode2D(camera);
+    SlideDraw(slide);
+    EndMode2D();
+    EndScissorMode();
+    EndTextureMode();
+
+    ThumbnailSlot *thumbnail = &thumbnails.slots[slot];
+    thumbnail->slide = index;
+    thumbnail->generation = slide->generation;
+    thumbnail->imageGeneration = imageGeneration;
+    thumbnail->missingImages = ThumbnailMissingImages(slide);
+    thumbnail->area = (Vector2){ area.width, area.height };
+    thumbnail->lastUsed = thumbnails.clock;
+    slide->thumbnail = slot + 1;
+    thumbnails.generation++;
+    thumbnails.drawn++;
+    TRACE_END("Thumbnail");
+}
+
+// Bring the thumbnails of slides [first, end) up to date for slides laid out
+// in area, within the per-frame budget. Main thread only, outside drawing.
+void ThumbnailsUpdate(int first, int end, Rectangle area)
+{
+    thumbnails.pending = 0;
+    if (!thumbnails.atlas.id || area.width <= 0 || area.height <= 0) {
+        return;
+    }
+    if (thumbnails.deckGeneration != deck.generation) {
+        ThumbnailsRebind();
+    }
+
+    // Stamp the whole strip first, so none of it is evicted for the rest
+    thumbnails.clock++;
+    for (int i = first; i < end; i++) {
+        const int slot = ThumbnailFind(i);
+        if (slot >= 0) {
+            thumbnails.slots[slot].lastUsed = thumbnails.clock;
+        }
+    }
+
+    const double start = GetTime();
+    for (int i = first; i < end; i++) {
+        if (!ThumbnailStale(i, area)) {
+            continue;
+        }
+        if (GetTime() - start >= THUMBNAIL_BUDGET_SECONDS) {
+            thumbnails.pending++;
+            continue;
+        }
+        int slot = ThumbnailFind(i);
+        if (slot < 0) {
+            slot = ThumbnailAllocate();
+        }
+        if (slot < 0) {
+            break;  // the strip is wider than the atlas
+        }
+        ThumbnailRender(i, slot, area);
+    }
+}
+
+// Where the slide's thumbnail is in thumbnails.atlas, flipped for drawing a
+// render texture. False while it has none yet; a stale one is still shown
+// until it is drawn again.
+bool ThumbnailSource(int index, Rectangle *source)
+{
+    const int slot = ThumbnailFind(index);
+    if (slot < 0) {
+        return false;
+    }
+    const Rectangle rect = ThumbnailSlotRect(slot);
+    *source = (Rectangle){ rect.x, THUMBNAIL_ATLAS_SIZE - rect.y - rect.height, rect.width, -rect.height };
+    return true;
+}
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "slideshow.h"
+
+// Event trace in the Chrome trace format, viewable in chrome://tracing or
+// ui.perfetto.dev. Each thread records into its own ring buffer without
+// locks: only the owner writes events and publishes them by advancing head
+// with a release store. A dump copies each ring from another thread and,
+// like a seqlock reader, checks head again afterwards to drop events the
+// owner may have started to overwrite while they were copied.
+//
+// TRACE_BEGIN/TRACE_END compile to a single test of trace.enabled when
+// tracing is off, so they stay in release builds.
+
+Trace trace;
+
+static PLATFORM_THREAD_LOCAL TraceRing *traceRing;
+
+void TraceInit(const char *path)
+{
+    trace.path = path;
+    trace.mutex = PlatformMutexCreate();
+    trace.start = PlatformTime();
+    trace.enabled = true;
+    TraceThreadName("main");
+}
+
+static TraceRing *TraceRegister(void)
+{
+    PlatformMutexLock(trace.mutex);
+    TraceRing *ring = 0;
+    if (trace.ringCount < MAX_TRACE_THREADS) {
+        ring = &trace.rings[trace.ringCount];
+        ring->events = calloc(TRACE_RING_EVENTS, sizeof(TraceEvent));
+        if (ring->events) {
+            trace.ringCount++;
+        } else {
+            ring = 0;
+        }
+    }
+    PlatformMutexUnlock(trace.mutex);
+    traceRing = ring;
+    return ring;
+}
+
+void TraceThreadName(const char *name)
+{
+    if (!trace.enabled) {
+        return;
+    }
+    TraceRing *ring = traceRing ? traceRing : TraceRegister();
+    if (ring) {
+        ring->threadName = name;
+    }
+}
+
+void TraceRecord(const char *name, int arg, char phase)
+{
+    TraceRing *ring = traceRing ? traceRing : TraceRegister();
+    if (!ring) {
+        return;
+    }
+    const unsigned int head = ring->head;
+    TraceEvent *event = &ring->events[head % TRACE_RING_EVENTS];
+    // A dump that sees the slot's new contents also sees head advanced past
+    // the event it held before
+    PlatformFenceRelease();
+    event->name = name;
+    event->arg = arg;
+    event->phase = phase;
+    event->time = PlatformTime();
+    PlatformAtomicStore(&ring->head, head + 1);
+}
+
+// Write every thread's recorded events to path. Safe to call while other
+// threads keep recording.
+bool TraceDump(const char *path)
+{
+    if (!trace.enabled) {
+        return false;
+    }
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        TraceLog(LOG_WARNING, "TRACE: Failed to open %s", path);
+        return false;
+    }
+
+    PlatformMutexLock(trace.mutex);
+    const int ringCount = trace.ringCount;
+    PlatformMutexUnlock(trace.mutex);
+
+    int written = 0;
+    fputs("{\"traceEvents\":[\n", file);
+    for (int r = 0; r < ringCount; r++) {
+        TraceRing *ring = &trace.rings[r];
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            written++ ? ",\n" : "", r, ring->threadName ? ring->threadName : "thread");
+
+        // Event i shares its slot with event i + TRACE_RING_EVENTS, which the
+        // owner writes while head is at that index. So the slot of event
+        // head - TRACE_RING_EVENTS, the next to be written, is skipped, and
+        // an event is torn once head has reached i + TRACE_RING_EVENTS.
+        const unsigned int head = PlatformAtomicLoad(&ring->head);
+        const unsigned int first = head >= TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS + 1 : 0;
+        for (unsigned int i = first; i != head; i++) {
+            const TraceEvent event = ring->events[i % TRACE_RING_EVENTS];
+            PlatformFenceAcquire();
+            if (PlatformAtomicLoad(&ring->head) - i >= TRACE_RING_EVENTS) {
+                continue;   // overwritten while being copied
+            }
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d",
+                event.name, event.phase, (event.time - trace.start) * 1e6, r);
+            if (event.arg >= 0) {
+                fprintf(file, ",\"args\":{\"id\":%d}", event.arg);
+            }
+            fputc('}', file);
+        }
+    }
+    fputs("\n]}\n", file);
+    const bool ok = !ferror(file);
+    fclose(file);
+
+    if (ok) {
+        TraceLog(LOG_INFO, "TRACE: Wrote %s", path);
+    } else {
+        TraceLog(LOG_WARNING, "TRACE: Failed to write %s", path);
+    }
+    return ok;
+}
+
+// Dump to the trace path and stop recording. Other threads must be done.
+void TraceShutdown(void)
+{
+    if (!trace.enabled) {
+        return;
+    }
+    TraceDump(trace.path);
+    trace.enabled = false;
+    for (int i = 0; i < trace.ringCount; i++) {
+        free(trace.rings[i].events);
+    }
+    PlatformMutexDestroy(trace.mutex);
+}
@@ -0,0 +1,241 @@
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "slideshow.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VIDEO_SSE2
+#include <emmintrin.h>
+#endif
+
+// Video export: the deck as a timed slideshow, streamed as uncompressed
+// YUV4MPEG2 (4:2:0, BT.601 limited range) to a file or stdout, so it can be
+// piped straight into an encoder, e.g.
+//
+//   slideshow deck.txt --video - | ffmpeg -i - out.mp4
+//
+// Slides are static, so each one is rasterized and converted to YUV once.
+// Frames that hold a slide write its planes again as they are, and
+// cross-fade frames blend the planes of two slides (the conversion is
+// affine, so blending YUV is blending RGB). Every buffer is allocated up
+// front; writing a frame allocates nothing.
+
+// Two rows of RGBA pixels to two rows of luma and one row of chroma, each
+// chroma sample the average of a 2x2 block. width is even.
+static void VideoConvertRows(const unsigned char *rgba0, const unsigned char *rgba1,
+    unsigned char *y0, unsigned char *y1, unsigned char *u, unsigned char *v, int width)
+{
+    int x = 0;
+#if defined(VIDEO_SSE2)
+    // 8 pixels of both rows per iteration. Channels are split into 16-bit
+    // lanes; luma sums stay below 2^16 so they are computed unsigned in
+    // 16 bits, chroma sums are signed and computed in 32 bits with madd.
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i lumaR = _mm_set1_epi16(66);
+    const __m128i lumaG = _mm_set1_epi16(129);
+    const __m128i lumaB = _mm_set1_epi16(25);
+    const __m128i lumaBias = _mm_set1_epi16(128 + (16 << 8));
+    const __m128i chromaRound = _mm_set1_epi16(512);
+    const __m128i chromaBias = _mm_set1_epi32(128);
+    const __m128i uRG = _mm_setr_epi16(-38, -74, -38, -74, -38, -74, -38, -74);
+    const __m128i uB = _mm_setr_epi16(112, 1, 112, 1, 112, 1, 112, 1);
+    const __m128i vRG = _mm_setr_epi16(112, -94, 112, -94, 112, -94, 112, -94);
+    const __m128i vB = _mm_setr_epi16(-18, 1, -18, 1, -18, 1, -18, 1);
+    for (; x + 8 <= width; x += 8) {
+        __m128i sumR = _mm_setzero_si128();
+        __m128i sumG = _mm_setzero_si128();
+        __m128i sumB = _mm_setzero_si128();
+        for (int row = 0; row < 2; row++) {
+            const unsigned char *rgba = (row ? rgba1 : rgba0) + x * 4;
+            const __m128i p0 = _mm_loadu_si128((const __m128i *)rgba);
+            const __m128i p1 = _mm_loadu_si128((const __m128i *)(rgba + 16));
+            const __m128i r = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+            const __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask), _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+            const __m128i b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask), _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+
+            __m128i luma = _mm_add_epi16(_mm_mullo_epi16(r, lumaR), _mm_mullo_epi16(g, lumaG));
+            luma = _mm_add_epi16(luma, _mm_add_epi16(_mm_mullo_epi16(b, lumaB), lumaBias));
+            luma = _mm_srli_epi16(luma, 8);
+            _mm_storel_epi64((__m128i *)((row ? y1 : y0) + x), _mm_packus_epi16(luma, luma));
+
+            sumR = _mm_add_epi16(sumR, r);
+            sumG = _mm_add_epi16(sumG, g);
+            sumB = _mm_add_epi16(sumB, b);
+        }
+
+        // Add horizontal neighbours: 4 sums of 2x2 blocks per channel
+        sumR = _mm_madd_epi16(sumR, ones);
+        sumG = _mm_madd_epi16(sumG, ones);
+        sumB = _mm_madd_epi16(sumB, ones);
+        sumR = _mm_packs_epi32(sumR, sumR);
+        sumG = _mm_packs_epi32(sumG, sumG);
+        sumB = _mm_packs_epi32(sumB, sumB);
+        const __m128i rg = _mm_unpacklo_epi16(sumR, sumG);
+        const __m128i b1 = _mm_unpacklo_epi16(sumB, chromaRound);
+
+        __m128i cu = _mm_add_epi32(_mm_madd_epi16(rg, uRG), _mm_madd_epi16(b1, uB));
+        __m128i cv = _mm_add_epi32(_mm_madd_epi16(rg, vRG), _mm_madd_epi16(b1, vB));
+        cu = _mm_add_epi32(_mm_srai_epi32(cu, 10), chromaBias);
+        cv = _mm_add_epi32(_mm_srai_epi32(cv, 10), chromaBias);
+        cu = _mm_packs_epi32(cu, cu);
+        cv = _mm_packs_epi32(cv, cv);
+        const int bitsU = _mm_cvtsi128_si32(_mm_packus_epi16(cu, cu));
+        const int bitsV = _mm_cvtsi128_si32(_mm_packus_epi16(cv, cv));
+        memcpy(u + x / 2, &bitsU, 4);
+        memcpy(v + x / 2, &bitsV, 4);
+    }
+#endif
+    for (; x < width; x += 2) {
+        int r = 0, g = 0, b = 0;
+        for (int i = 0; i < 4; i++) {
+            const unsigned char *p = (i < 2 ? rgba0 : rgba1) + (x + (i & 1)) * 4;
+            (i < 2 ? y0 : y1)[x + (i & 1)] = (unsigned char)(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+            r += p[0];
+            g += p[1];
+            b += p[2];
+        }
+        u[x / 2] = (unsigned char)(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+        v[x / 2] = (unsigned char)(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+    }
+}
+
+// Convert an RGBA image with even dimensions to Y, U and V planes stored
+// back to back in yuv
+static void VideoConvert(const Image *image, unsigned char *yuv)
+{
+    const int width = image->width;
+    const int height = image->height;
+    const unsigned char *rgba = image->data;
+    unsigned char *u = yuv + width * height;
+    unsigned char *v = u + (width / 2) * (height / 2);
+    for (int y = 0; y < height; y += 2) {
+        VideoConvertRows(rgba + (size_t)y * width * 4, rgba + (size_t)(y + 1) * width * 4,
+            yuv + (size_t)y * width, yuv + (size_t)(y + 1) * width,
+            u + (size_t)(y / 2) * (width / 2), v + (size_t)(y / 2) * (width / 2), width);
+    }
+}
+
+// out = a + (b - a) * weight / 256
+static void VideoBlend(const unsigned char *a, const unsigned char *b, unsigned char *out, size_t size, int weight)
+{
+    size_t i = 0;
+#if defined(VIDEO_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weightA = _mm_set1_epi16((short)(256 - weight));
+    const __m128i weightB = _mm_set1_epi16((short)weight);
+    const __m128i round = _mm_set1_epi16(128);
+    for (; i + 16 <= size; i += 16) {
+        const __m128i pa = _mm_loadu_si128((const __m128i *)(a + i));
+        const __m128i pb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pa, zero), weightA), _mm_mullo_epi16(_mm_unpacklo_epi8(pb, zero), weightB));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pa, zero), weightA), _mm_mullo_epi16(_mm_unpackhi_epi8(pb, zero), weightB));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 8);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < size; i++) {
+        out[i] = (unsigned char)((a[i] * (256 - weight) + b[i] * weight + 128) >> 8);
+    }
+}
+
+// raylib logs to stdout, which carries the video when streaming
+static void VideoTraceLog(int logLevel, const char *text, va_list args)
+{
+    static const char *levels[] = { "", "TRACE: ", "DEBUG: ", "INFO: ", "WARNING: ", "ERROR: ", "FATAL: ", "" };
+    fputs(levels[logLevel >= 0 && logLevel < 8 ? logLevel : 0], stderr);
+    vfprintf(stderr, text, args);
+    fputc('\n', stderr);
+}
+
+// Stream the deck to outputPath ("-" for stdout) at fps. Slides without a
+// duration or fade of their own use slideSeconds and fadeSeconds.
+bool ExportVideo(const char *deckPath, const char *outputPath, int width, int height, int fps, float slideSeconds, float fadeSeconds)
+{
+    const bool toStdout = !strcmp(outputPath, "-");
+    FILE *report = toStdout ? stderr : stdout;
+    if (toStdout) {
+        SetTraceLogCallback(VideoTraceLog);
+    }
+    if (width % 2 || height % 2 || fps <= 0 || slideSeconds <= 0) {
+        TraceLog(LOG_WARNING, "VIDEO: Size must be even and fps and slide duration positive");
+        return false;
+    }
+
+    FILE *file = stdout;
+    if (toStdout) {
+        PlatformSetBinaryMode(stdout);
+    } else {
+        file = fopen(outputPath, "wb");
+        if (!file) {
+            TraceLog(LOG_WARNING, "VIDEO: Failed to open %s", outputPath);
+            return false;
+        }
+    }
+    if (!ExportBegin(deckPath, width, height)) {
+        if (!toStdout) fclose(file);
+        return false;
+    }
+
+    const size_t frameSize = (size_t)width * height + 2 * (size_t)(width / 2) * (height / 2);
+    Image target = GenImageColor(width, height, BLACK);
+    unsigned char *previous = MemAlloc((unsigned int)frameSize);
+    unsigned char *current = MemAlloc((unsigned int)frameSize);
+    unsigned char *blended = MemAlloc((unsigned int)frameSize);
+    bool ok = target.data && previous && current && blended;
+
+    long long frame = 0;
+    const double start = PlatformTime();
+    if (ok) {
+        ok = fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps) > 0;
+    }
+    double time = 0;
+    for (int i = 0; i < slideCount && ok; i++) {
+        const Slide *slide = &slides[i];
+        time += slide->duration > 0 ? slide->duration : slideSeconds;
+        const long long endFrame = llround(time * fps);
+        const long long frames = endFrame - frame;
+
+        ExportRasterize(i, &target);
+        VideoConvert(&target, current);
+
+        // The fade into a slide takes up the start of its time on screen
+        long long fadeFrames = i ? llround((slide->fade >= 0 ? slide->fade : fadeSeconds) * fps) : 0;
+        if (fadeFrames > frames) fadeFrames = frames;
+        for (long long f = 0; f < frames && ok; f++) {
+            const unsigned char *data = current;
+            if (f < fadeFrames) {
+                VideoBlend(previous, current, blended, frameSize, (int)((f + 1) * 256 / (fadeFrames + 1)));
+                data = blended;
+            }
+            ok = fputs("FRAME\n", file) >= 0 && fwrite(data, 1, frameSize, file) == frameSize;
+        }
+        frame = endFrame;
+
+        unsigned char *swap = previous;
+        previous = current;
+        current = swap;
+    }
+    ok = ok && !fflush(file);
+    const double elapsed = PlatformTime() - start;
+
+    if (!ok) {
+        TraceLog(LOG_WARNING, "VIDEO: Failed to write %s", outputPath);
+    } else {
+        fprintf(report, "video: %lld frames (%d slides) at %dx%d, %d fps in %.3f s (%.1f frames/s, %.1f MiB/s)\n",
+            frame, slideCount, width, height, fps, elapsed, frame / elapsed,
+            frame * (double)frameSize / (1024.0 * 1024.0) / elapsed);
+    }
+
+    UnloadImage(target);
+    MemFree(previous);
+    MemFree(current);
+    MemFree(blended);
+    if (!toStdout) {
+        fclose(file);
+    }
+    ExportEnd();
+    return ok;
+}